@@ -1,7 +1,11 @@
+#define _GNU_SOURCE /* sched_setaffinity */
 #include <stdio.h>
+#include <sched.h>
 #include <signal.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 
@@ -9,17 +13,61 @@ typedef enum {
     ARRIVAL, SHORTEST_JOB, PRIORITY
 } sort_by;
 
+typedef enum {
+    REAL_TIME, VIRTUAL_TIME
+} exec_mode;
+
 typedef struct process {
-    char Name[51];
-    char Description[101];
+    int Name;        /* offset of the name in the string arena */
+    int Description; /* offset of the description in the string arena */
     int Arrival_Time;
     int Burst_Time;
     int Remaining_Time;
     int Priority;
+    int Affinity; /* CPU the process is restricted to in SMP mode, -1 = any */
     pid_t pid;
 } P;
 
-char buf[396];
+/**
+ * @brief Per-CPU state of the SMP scheduler
+ */
+typedef struct cpu {
+    int running;      /* process on the CPU, -1 when idle */
+    int slice_end;    /* time the running slice ends */
+    int slice_start;
+    int head, tail;   /* run queue, linked through the next_in_queue array */
+    int queued;
+    long busy;        /* time units spent running processes */
+    int slices;
+    int steals;       /* processes taken from other run queues */
+} cpu;
+
+/**
+ * @brief Interned string storage: every distinct string is stored once in a
+ *        growing buffer and referred to by its offset.
+ */
+typedef struct string_arena {
+    char * data;
+    size_t size, capacity;
+    int * slots;           /* open-addressing table of offset + 1, 0 = empty */
+    size_t num_slots, used;
+} string_arena;
+
+char buf[1024];
+string_arena strings; // Names and descriptions of the loaded processes
+
+exec_mode mode = REAL_TIME; // REAL_TIME runs child processes, VIRTUAL_TIME only advances the clock
+long time_unit_us = 1000000; // Length of one time unit in REAL_TIME, in microseconds
+
+#define MLFQ_MAX_LEVELS 8
+int mlfq_levels = 0;                 // MLFQ queue levels, 0 = derived from the RR quantum
+int mlfq_quanta[MLFQ_MAX_LEVELS];    // Time allotment per level, top level first
+int mlfq_boost = 0;                  // Priority boost period (0 = never)
+int cfs_latency = 0;                 // CFS target latency, 0 = 4 quanta
+int cfs_min_granularity = 0;         // CFS minimum slice, 0 = one quantum
+
+#define MAX_CPUS 64
+int num_cpus = 1;                    // Simulated CPUs, the SMP scheduler runs when > 1
 
 void output_to_screen() {
     /* writes the contents of buf to the standard output */
@@ -75,22 +123,131 @@ int max(int a, int b) {
 }
 
 /**
- @brief Fills an array of processes with data from a CSV file
+ @brief FNV-1a hash of a string of length n
+ */
+size_t hash_string(const char * str, size_t n) {
+    size_t h = 14695981039346656037UL;
+    for (size_t i = 0; i < n; i++) {
+        h ^= (unsigned char)str[i];
+        h *= 1099511628211UL;
+    }
+    return h;
+}
+
+/**
+ @brief Returns the string stored at an offset of the arena
+ */
+const char * string_at(int offset) {
+    return strings.data + offset;
+}
+
+/**
+ @brief Stores a string in the arena once, returning the offset of the copy
+ @param a String arena
+ @param str Characters of the string (need not be terminated)
+ @param n Length of the string
+ @return Offset of the interned string
+ */
+int intern_string(string_arena * a, const char * str, size_t n) {
+
+    if (2 * (a->used + 1) > a->num_slots) { /* keep the table at most half full */
+        size_t num_slots = a->num_slots ? 2 * a->num_slots : 1024;
+        int * slots = calloc(num_slots, sizeof(int));
+
+        for (size_t i = 0; i < a->num_slots; i++) {
+            if (a->slots[i]) {
+                const char * old = a->data + a->slots[i] - 1;
+                size_t j = hash_string(old, strlen(old)) & (num_slots - 1);
+                while (slots[j]) j = (j + 1) & (num_slots - 1);
+                slots[j] = a->slots[i];
+            }
+        }
+        free(a->slots);
+        a->slots = slots;
+        a->num_slots = num_slots;
+    }
+
+    size_t j = hash_string(str, n) & (a->num_slots - 1);
+    for (; a->slots[j]; j = (j + 1) & (a->num_slots - 1)) {
+        const char * old = a->data + a->slots[j] - 1;
+        if (strncmp(old, str, n) == 0 && old[n] == '\0')
+            return a->slots[j] - 1;
+    }
+
+    if (a->size + n + 1 > a->capacity) {
+        a->capacity = 2 * a->capacity > a->size + n + 4096 ? 2 * a->capacity : a->size + n + 4096;
+        a->data = realloc(a->data, a->capacity);
+    }
+
+    int offset = a->size;
+    memcpy(a->data + offset, str, n);
+    a->data[offset + n] = '\0';
+    a->size += n + 1;
+
+    a->slots[j] = offset + 1;
+    a->used++;
+    return offset;
+}
+
+/**
+ @brief Frees the storage of a string arena
+ */
+void free_arena(string_arena * a) {
+    free(a->data);
+    free(a->slots);
+    memset(a, 0, sizeof(*a));
+}
+
+/**
+ @brief Fills a growing array of processes with data from a CSV file.
+        Names and descriptions are interned in the string arena. An optional
+        sixth column restricts the process to one CPU in SMP mode.
  @param path Path to the CSV file
- @param p_array Array of processes to fill
+ @param p_array Set to the newly allocated array of processes
  @return Number of processes read from the file
  */
-int fill_processes_array(char * path, P p_array[]) {
+int fill_processes_array(char * path, P ** p_array) {
     FILE * csv = get_csv_file(path);
-    int i = 0;
-    char c;
-    while (fscanf(csv, "%[^,]%*c%[^,]%*c%d,%d,%d", p_array[i].Name, p_array[i].Description,
-        &p_array[i].Arrival_Time, &p_array[i].Burst_Time, &p_array[i].Priority) != EOF) {
-            p_array[i].Remaining_Time = p_array[i].Burst_Time;
-            i++;
-            fscanf(csv, "%c", &c);
+    char * line = NULL;
+    size_t line_size = 0;
+    int len = 0, capacity = 1024;
+
+    *p_array = malloc(sizeof(P) * capacity);
+
+    while (getline(&line, &line_size, csv) != -1) {
+        char * name = line;
+        char * description = strchr(name, ',');
+        char * fields = description ? strchr(description + 1, ',') : NULL;
+
+        if (fields == NULL)
+            continue; /* blank or malformed line */
+
+        if (len == capacity) {
+            capacity *= 2;
+            *p_array = realloc(*p_array, sizeof(P) * capacity);
         }
-    return i;
+
+        P * p = &(*p_array)[len];
+        p->Affinity = -1;
+        if (sscanf(fields + 1, "%d,%d,%d,%d", &p->Arrival_Time, &p->Burst_Time, &p->Priority,
+            &p->Affinity) < 3)
+            continue;
+
+        if (p->Affinity < -1 || p->Affinity >= num_cpus) { /* pinned to a CPU that does not exist */
+            fprintf(stderr, "invalid CPU affinity %d, skipping %.*s\n", p->Affinity,
+                (int)(description - name), name);
+            continue;
+        }
+
+        p->Name = intern_string(&strings, name, description - name);
+        p->Description = intern_string(&strings, description + 1, fields - description - 1);
+        p->Remaining_Time = p->Burst_Time;
+        len++;
+    }
+
+    free(line);
+    fclose(csv);
+    return len;
 }
 
 /**
@@ -120,13 +277,41 @@ void set_alarm_handler() {
 
 int time = 0; // global time
 
+/**
+ @brief Waits for a number of time units with a one-shot interval timer.
+        SIGALRM stays blocked until sigsuspend, so a timer that expires
+        before the wait starts is not lost.
+ @param units Number of time units (of time_unit_us microseconds each)
+ */
+void wait_time_units(int units) {
+    struct itimerval timer = {0};
+    sigset_t alarm_set, old_set;
+    long us = (long)units * time_unit_us;
+
+    if (us <= 0) {
+        return; /* a zero timer would never fire */
+    }
+
+    sigemptyset(&alarm_set);
+    sigaddset(&alarm_set, SIGALRM);
+    sigprocmask(SIG_BLOCK, &alarm_set, &old_set);
+
+    timer.it_value.tv_sec = us / 1000000;
+    timer.it_value.tv_usec = us % 1000000;
+    setitimer(ITIMER_REAL, &timer, NULL); /* Set alarm */
+
+    sigsuspend(&old_set); /* Wait for the alarm */
+    sigprocmask(SIG_SETMASK, &old_set, NULL);
+}
+
 /**
  @brief Simulates idle time of the CPU
  @param burst_time Duration of idle time
  */
 void idle_burst(int burst_time) {
-    alarm(burst_time); /* Set alarm */
-    pause(); /* Wait for the alarm */
+    if (mode == REAL_TIME) {
+        wait_time_units(burst_time);
+    }
 
     sprintf(buf, "%d → %d: Idle.\n", time, burst_time + time);
     output_to_screen();
@@ -138,12 +323,26 @@ void idle_burst(int burst_time) {
  @param burst_time Duration of the CPU burst
  */
 void burst(pid_t pid, int burst_time) {
+    if (mode == VIRTUAL_TIME) {
+        return; /* The caller advances the virtual clock */
+    }
+
     kill(pid, SIGCONT); /* Continue the child process */
-    alarm(burst_time); /* Set alarm */
-    pause(); /* Wait for the alarm */
+    wait_time_units(burst_time);
     kill(pid, SIGSTOP); /* Stop the child process */
 }
 
+/**
+ * @brief Kills and reaps the child of a finished process (REAL_TIME only)
+ * @param p Pointer to the process instance
+ */
+void reap_child(P * p) {
+    if (mode == REAL_TIME) {
+        kill(p->pid, SIGKILL);
+        waitpid(p->pid, NULL, 0);
+    }
+}
+
 /**
  * @brief Simulates a CPU burst for a single process
  * @param p Pointer to the process instance
@@ -154,13 +353,35 @@ void simulate_cpu_burst(P * p) {
     p->Remaining_Time -= Burst_Time;
 
     burst(p->pid, Burst_Time);
-    sprintf(buf, "%d → %d: %s Running %s.\n", time, Burst_Time + time, p->Name, p->Description);
+    snprintf(buf, sizeof(buf), "%d → %d: %s Running %s.\n", time, Burst_Time + time,
+        string_at(p->Name), string_at(p->Description));
     output_to_screen();
 
     if (p->Remaining_Time == 0) { /* Process finished running */
-        kill(p->pid, SIGKILL);
-        waitpid(p->pid, NULL, 0);
+        reap_child(p);
+    }
+}
+
+/**
+ * @brief Admits the processes that have arrived by now into Round Robin.
+ *        A process that arrives with no remaining time is finished at once.
+ * @param p_array Array of processes, sorted by arrival time
+ * @param len Length of the process array
+ * @param arrived Number of processes admitted so far, updated
+ * @return Number of admitted processes that are already finished
+ */
+int admit_arrivals(P p_array[], int len, int * arrived) {
+
+    int done = 0;
+
+    for (; *arrived < len && p_array[*arrived].Arrival_Time <= time; (*arrived)++) {
+        if (p_array[*arrived].Remaining_Time <= 0) {
+            p_array[*arrived].Remaining_Time = 0;
+            reap_child(&p_array[*arrived]);
+            done++;
+        }
     }
+    return done;
 }
 
 /**
@@ -170,32 +391,36 @@ void simulate_cpu_burst(P * p) {
  */
 void run_preemptive(P p_array[], int len) {
 
-    int finished = 0, i = 0, j, arrived = 1;
+    int finished = 0, i = 0, k, arrived = 0;
 
     while (finished != len) { /* Continue until all processes have finished */
-        
-        if ((p_array[i].Arrival_Time - time) > 0) { /* Check for idle time */
-            idle_burst(p_array[i].Arrival_Time - time);
-            time = p_array[i].Arrival_Time;
-        }
 
-        if (p_array[i].Remaining_Time) {
+        finished += admit_arrivals(p_array, len, &arrived);
 
-            p_array[i].Burst_Time = min(p_array[i].Burst_Time, p_array[i].Remaining_Time);
-            simulate_cpu_burst(&p_array[i]); /* Simulate a burst */
-            time += p_array[i].Burst_Time;
+        /* Next arrived process, in cyclic order, that still has work left */
+        for (k = 0; k < arrived && !p_array[(i + k) % arrived].Remaining_Time; k++);
 
-            if (p_array[i].Remaining_Time == 0) {
-                finished++;
-                i++;
-                continue;
+        if (k == arrived) { /* Every arrived process is done: idle until the next arrival */
+            if (arrived < len) {
+                idle_burst(p_array[arrived].Arrival_Time - time);
+                time = p_array[arrived].Arrival_Time;
             }
+            i = arrived;
+            continue;
         }
-  
-        j = i + 1;
-        while (j < len && p_array[j++].Arrival_Time <= time) 
-            arrived++; /* Update number of processes that have arrived */
-       
+
+        i = (i + k) % arrived;
+
+        p_array[i].Burst_Time = min(p_array[i].Burst_Time, p_array[i].Remaining_Time);
+        simulate_cpu_burst(&p_array[i]); /* Simulate a burst */
+        time += p_array[i].Burst_Time;
+
+        if (p_array[i].Remaining_Time == 0) {
+            finished++;
+        }
+
+        finished += admit_arrivals(p_array, len, &arrived);
+
         i = (i + 1) % arrived;
     }
 }
@@ -205,9 +430,9 @@ void run_preemptive(P p_array[], int len) {
  * @param len Length of the process array
  * @return Average waiting time of all processes
  */
-float run_non_preemptive(P p_array[], int len) {
+double run_non_preemptive(P p_array[], int len) {
 
-    float waiting_time = 0;
+    double waiting_time = 0;
 
     for (int i = 0; i < len; i++) {
 
@@ -262,34 +487,27 @@ int cmp_priority(P a1, P a2) {
  * @param mid Middle index to divide the subarrays
  * @param right Right index of the subarray
  * @param cmp Comparison function to decide the ordering
+ * @param tmp Scratch buffer at least as long as arr
  */
-void merge(P arr[], int left, int mid, int right, int (*cmp)(P, P)) {
-
-    int i, j, k;
-    int n1 = mid - left + 1;
-    int n2 = right - mid;
-
-    P L[n1], R[n2];
+void merge(P arr[], int left, int mid, int right, int (*cmp)(P, P), P tmp[]) {
 
-    for (i = 0; i < n1; i++)
-        L[i] = arr[left + i];
-    for (j = 0; j < n2; j++)
-        R[j] = arr[mid + 1 + j];
+    int i = left, j = mid + 1, k = left;
 
-    i = 0; j = 0; k = left;
+    for (int n = left; n <= right; n++)
+        tmp[n] = arr[n];
 
-    while (i < n1 && j < n2) {
-        if (cmp(L[i], R[j])) {
-            arr[k++] = L[i++];
+    while (i <= mid && j <= right) {
+        if (cmp(tmp[i], tmp[j])) {
+            arr[k++] = tmp[i++];
         } else {
-            arr[k++] = R[j++];
+            arr[k++] = tmp[j++];
         }
     }
 
-    while (i < n1)
-        arr[k++] = L[i++];
-    while (j < n2)
-        arr[k++] = R[j++];
+    while (i <= mid)
+        arr[k++] = tmp[i++];
+    while (j <= right)
+        arr[k++] = tmp[j++];
 }
 
 /**
@@ -298,18 +516,19 @@ void merge(P arr[], int left, int mid, int right, int (*cmp)(P, P)) {
  * @param left Left index of the array/subarray
  * @param right Right index of the array/subarray
  * @param cmp Comparison function used to order elements
+ * @param tmp Scratch buffer at least as long as arr
  */
-void mergeSort(P arr[], int left, int right, int (*cmp)(P, P)) {
+void mergeSort(P arr[], int left, int right, int (*cmp)(P, P), P tmp[]) {
 
     if (left < right) {
         int mid = left + (right - left) / 2;
 
         // Sort first and second halves
-        mergeSort(arr, left, mid, cmp);
-        mergeSort(arr, mid + 1, right, cmp);
+        mergeSort(arr, left, mid, cmp, tmp);
+        mergeSort(arr, mid + 1, right, cmp, tmp);
 
         // Merge the sorted halves
-        merge(arr, left, mid, right, cmp);
+        merge(arr, left, mid, right, cmp, tmp);
     }
 }
 
@@ -321,20 +540,24 @@ void mergeSort(P arr[], int left, int right, int (*cmp)(P, P)) {
  */
 void sort(P p_array[], int len, sort_by sortby) {
 
+    P * tmp = malloc(sizeof(P) * (len > 0 ? len : 1)); /* merge buffer */
+
     switch (sortby)
     {
         case ARRIVAL:
-            mergeSort(p_array, 0, len - 1, cmp_arrival);
+            mergeSort(p_array, 0, len - 1, cmp_arrival, tmp);
             break;
         case SHORTEST_JOB:
-            mergeSort(p_array, 0, len - 1, cmp_shortest_job);
+            mergeSort(p_array, 0, len - 1, cmp_shortest_job, tmp);
             break;
         case PRIORITY:
-            mergeSort(p_array, 0, len - 1, cmp_priority);
+            mergeSort(p_array, 0, len - 1, cmp_priority, tmp);
             break;
         default:
             break;
     }
+
+    free(tmp);
 }
 
 /**
@@ -348,6 +571,11 @@ void create_child_proccess(P p_array[], int len) {
     for (int i = 0; i < len; i++) {
         p_array[i].Remaining_Time = p_array[i].Burst_Time; /* initialize remaining time */
 
+        if (mode == VIRTUAL_TIME) {
+            p_array[i].pid = 0; /* no child, bursts only advance the clock */
+            continue;
+        }
+
         pid_t pid = fork();
 
         if (pid != 0) {  /* Parent process */
@@ -403,42 +631,936 @@ void print_p_closing(int TAT) {
     output_to_screen();
 }
 /**
- * @brief Moves an array element from one position to another.
- *        Allows a process that arrived earlier to run first.
- * @param p_array Processes array
- * @param from Index to move from
- * @param to Index to move to
+ * @brief Prints the closing summary for preemptive queue-based algorithms (SRTF, Priority).
+ * @param avg_WT Average waiting time of all processes
+ * @param avg_RT Average response time of all processes
+ */
+void print_pq_closing(double avg_WT, double avg_RT) {
+
+    sprintf(buf, "\n──────────────────────────────────────────────\n\
+>> Engine Status  : Completed\n\
+>> Summary        :\n\
+   ├─ Average Waiting Time  : %.2f time units\n\
+   └─ Average Response Time : %.2f time units\n\
+>> End of Report\n\
+══════════════════════════════════════════════\n", avg_WT, avg_RT);
+    output_to_screen();
+}
+
+/**
+ * @brief Prints the closing summary for the SMP scheduler, with one line per CPU.
+ * @param cpu_state Per-CPU state after the run
+ * @param cpus Number of CPUs
+ * @param makespan Time the last process finished
+ * @param avg_WT Average waiting time of all processes
+ * @param avg_RT Average response time of all processes
+ */
+void print_smp_closing(cpu cpu_state[], int cpus, int makespan, double avg_WT, double avg_RT) {
+
+    sprintf(buf, "\n──────────────────────────────────────────────\n\
+>> Engine Status  : Completed\n\
+>> Summary        :\n\
+   ├─ Makespan              : %d time units\n\
+   ├─ Average Waiting Time  : %.2f time units\n\
+   ├─ Average Response Time : %.2f time units\n", makespan, avg_WT, avg_RT);
+    output_to_screen();
+
+    for (int c = 0; c < cpus; c++) {
+        sprintf(buf, "   %s CPU %-2d : %5.1f%% busy, %d slices, %d stolen\n", c == cpus - 1 ? "└─" : "├─", c,
+            makespan ? 100.0 * cpu_state[c].busy / makespan : 0.0, cpu_state[c].slices, cpu_state[c].steals);
+        output_to_screen();
+    }
+
+    sprintf(buf, ">> End of Report\n\
+══════════════════════════════════════════════\n");
+    output_to_screen();
+}
+
+/**
+ * @brief Ready queue: a binary min-heap of indices into an arrival-sorted
+ *        process array, ordered by a key comparison (burst, priority, ...).
+ */
+typedef struct ready_queue {
+    int * heap;                         /* process indices, heap[0] runs next */
+    int size;
+    P * procs;                          /* process array the indices refer to */
+    int (*before)(const P *, const P *); /* strict key order, ties fall back to index */
+} ready_queue;
+
+/**
+ * @brief Orders by burst time, then arrival time
+ */
+int before_shortest_job(const P * a, const P * b) {
+    if (a->Burst_Time != b->Burst_Time) return a->Burst_Time < b->Burst_Time;
+    return a->Arrival_Time < b->Arrival_Time;
+}
+
+/**
+ * @brief Orders by priority (lower value first), then arrival time
+ */
+int before_priority(const P * a, const P * b) {
+    if (a->Priority != b->Priority) return a->Priority < b->Priority;
+    return a->Arrival_Time < b->Arrival_Time;
+}
+
+/**
+ * @brief Creates an empty ready queue for up to len processes
+ * @param procs Process array, sorted by arrival time
+ * @param len Length of the process array
+ * @param before Key order of the queue
+ * @return The ready queue
+ */
+ready_queue rq_create(P procs[], int len, int (*before)(const P *, const P *)) {
+    ready_queue q;
+    q.heap = malloc(sizeof(int) * (len > 0 ? len : 1));
+    q.size = 0;
+    q.procs = procs;
+    q.before = before;
+    return q;
+}
+
+/**
+ * @brief Frees the heap of a ready queue
+ * @param q Ready queue
+ */
+void rq_free(ready_queue * q) {
+    free(q->heap);
+    q->heap = NULL;
+    q->size = 0;
+}
+
+/**
+ * @brief Returns 1 if process i is dispatched before process j
+ */
+int rq_less(ready_queue * q, int i, int j) {
+    if (q->before(&q->procs[i], &q->procs[j])) return 1;
+    if (q->before(&q->procs[j], &q->procs[i])) return 0;
+    return i < j; /* equal keys: earlier in arrival order first */
+}
+
+/**
+ * @brief Adds a process to the ready queue (O(log n))
+ * @param q Ready queue
+ * @param i Index of the process
  */
-void bring_to_pos(P p_array[], int from, int to) {
+void rq_push(ready_queue * q, int i) {
+    int pos = q->size++;
+
+    while (pos > 0 && rq_less(q, i, q->heap[(pos - 1) / 2])) { /* sift up */
+        q->heap[pos] = q->heap[(pos - 1) / 2];
+        pos = (pos - 1) / 2;
+    }
+    q->heap[pos] = i;
+}
 
-    P temp;
-    for (int i = from; i > to; i--) {
-        temp = p_array[i];
-        p_array[i] = p_array[i - 1];
-        p_array[i - 1] = temp;
+/**
+ * @brief Removes the next process to run from the ready queue (O(log n))
+ * @param q Ready queue (non-empty)
+ * @return Index of the process
+ */
+int rq_pop(ready_queue * q) {
+    int top = q->heap[0];
+    int last = q->heap[--q->size];
+    int pos = 0, child;
+
+    while ((child = 2 * pos + 1) < q->size) { /* sift down */
+        if (child + 1 < q->size && rq_less(q, q->heap[child + 1], q->heap[child]))
+            child++;
+        if (!rq_less(q, q->heap[child], last))
+            break;
+        q->heap[pos] = q->heap[child];
+        pos = child;
     }
+    q->heap[pos] = last;
+
+    return top;
 }
 
 /**
- * @brief Sorts the process array by arrival time.
- *        Ensures that processes that arrive first get to run first.
- * @param p_array Processes array
+ * @brief Simulates a non-preemptive scheduler driven by a ready queue.
+ *        Arrivals are pushed as the clock passes them and the head of the
+ *        queue runs to completion, in O(n log n) overall.
+ * @param p_array Array of processes, sorted by arrival time
  * @param len Length of the process array
+ * @param before Key order of the ready queue
+ * @return Average waiting time of all processes
  */
-void sort_by_prop(P p_array[], int len) {
+double run_ready_queue(P p_array[], int len, int (*before)(const P *, const P *)) {
 
-    int time = 0;
+    ready_queue q = rq_create(p_array, len, before);
+    double waiting_time = 0;
+    int next = 0; /* next process to arrive */
 
-    for (int i = 0; i < len; i++) {
-        for (int j = i; j < len; j++) {
-            if (p_array[j].Arrival_Time <= time) {
-                time += p_array[j].Burst_Time;
-                bring_to_pos(p_array, j, i);
+    for (int done = 0; done < len; done++) {
+
+        if (q.size == 0 && (p_array[next].Arrival_Time - time) > 0) { /* Check for idle CPU time */
+            idle_burst(p_array[next].Arrival_Time - time);
+            time = p_array[next].Arrival_Time;
+        }
+
+        while (next < len && p_array[next].Arrival_Time <= time)
+            rq_push(&q, next++); /* Admit arrived processes */
+
+        int i = rq_pop(&q);
+        waiting_time += time - p_array[i].Arrival_Time;
+
+        simulate_cpu_burst(&p_array[i]); /* Run the process */
+        time += p_array[i].Burst_Time;
+    }
+
+    rq_free(&q);
+    return len ? waiting_time / len : 0;
+}
+
+/**
+ * @brief Orders by remaining time, then arrival time
+ */
+int before_shortest_remaining(const P * a, const P * b) {
+    if (a->Remaining_Time != b->Remaining_Time) return a->Remaining_Time < b->Remaining_Time;
+    return a->Arrival_Time < b->Arrival_Time;
+}
+
+/**
+ * @brief Simulates a preemptive scheduler driven by a ready queue (SRTF,
+ *        preemptive Priority). The head of the queue runs until it finishes
+ *        or until a process arrives that is ahead of it in key order; the
+ *        preempted process goes back into the queue.
+ * @param p_array Array of processes, sorted by arrival time
+ * @param len Length of the process array
+ * @param before Key order of the ready queue
+ * @param avg_RT Set to the average response time (first run - arrival)
+ * @return Average waiting time of all processes
+ */
+double run_preemptive_queue(P p_array[], int len, int (*before)(const P *, const P *), double * avg_RT) {
+
+    ready_queue q = rq_create(p_array, len, before);
+    int * burst_time = malloc(sizeof(int) * (len > 0 ? len : 1)); /* Burst_Time holds the slice */
+    int * started = calloc(len > 0 ? len : 1, sizeof(int));
+    double waiting_time = 0, response_time = 0;
+    int next = 0, finished = 0; /* next process to arrive */
+
+    for (int i = 0; i < len; i++)
+        burst_time[i] = p_array[i].Burst_Time;
+
+    while (finished != len) {
+
+        if (q.size == 0 && (p_array[next].Arrival_Time - time) > 0) { /* Check for idle CPU time */
+            idle_burst(p_array[next].Arrival_Time - time);
+            time = p_array[next].Arrival_Time;
+        }
+
+        while (next < len && p_array[next].Arrival_Time <= time)
+            rq_push(&q, next++); /* Admit arrived processes */
+
+        int i = rq_pop(&q);
+        P * p = &p_array[i];
+        int remaining = p->Remaining_Time, slice = remaining;
+
+        if (!started[i]) {
+            started[i] = 1;
+            response_time += time - p->Arrival_Time;
+        }
+
+        /* Admit arrivals during the burst; the first one ahead of p preempts it */
+        while (next < len && p_array[next].Arrival_Time < time + remaining) {
+            int at = p_array[next].Arrival_Time;
+            p->Remaining_Time = remaining - (at - time); /* p as it will be at the arrival */
+            int preempts = before(&p_array[next], p);
+
+            rq_push(&q, next++);
+            if (preempts) {
+                slice = at - time;
                 break;
             }
         }
+
+        p->Remaining_Time = remaining;
+        p->Burst_Time = slice;
+        simulate_cpu_burst(p); /* Run until completion or preemption */
+        time += slice;
+
+        if (p->Remaining_Time == 0) {
+            finished++;
+            waiting_time += time - p->Arrival_Time - burst_time[i];
+        } else {
+            rq_push(&q, i); /* Preempted: back into the ready queue */
+        }
+    }
+
+    for (int i = 0; i < len; i++)
+        p_array[i].Burst_Time = burst_time[i];
+
+    free(burst_time);
+    free(started);
+    rq_free(&q);
+
+    *avg_RT = len ? response_time / len : 0;
+    return len ? waiting_time / len : 0;
+}
+
+/**
+ * @brief FIFO queue of process indices (one MLFQ level)
+ */
+typedef struct fifo_queue {
+    int * items;
+    int head, size, capacity;
+} fifo_queue;
+
+/**
+ * @brief Appends a process index to the back of a FIFO queue
+ */
+void fifo_push(fifo_queue * q, int i) {
+    q->items[(q->head + q->size++) % q->capacity] = i;
+}
+
+/**
+ * @brief Removes the process index at the front of a FIFO queue
+ */
+int fifo_pop(fifo_queue * q) {
+    int i = q->items[q->head];
+    q->head = (q->head + 1) % q->capacity;
+    q->size--;
+    return i;
+}
+
+/**
+ * @brief Simulates a multilevel feedback queue. New processes enter the top
+ *        level, the highest non-empty level runs first (FIFO within a level),
+ *        and a process that uses up the allotment of its level moves one level
+ *        down. An arrival preempts a process below the top level; the preempted
+ *        process keeps what is left of its allotment. Every mlfq_boost time
+ *        units all processes return to the top level (at the next dispatch).
+ * @param p_array Array of processes, sorted by arrival time
+ * @param len Length of the process array
+ * @param levels Number of levels
+ * @param quanta Allotment of each level
+ * @param boost Boost period, 0 for none
+ * @param avg_RT Set to the average response time
+ * @return Average waiting time of all processes
+ */
+double run_mlfq(P p_array[], int len, int levels, const int quanta[], int boost, double * avg_RT) {
+
+    fifo_queue queues[MLFQ_MAX_LEVELS];
+    int * level = calloc(len > 0 ? len : 1, sizeof(int));
+    int * used = calloc(len > 0 ? len : 1, sizeof(int)); /* allotment used at the current level */
+    int * burst_time = malloc(sizeof(int) * (len > 0 ? len : 1));
+    int * started = calloc(len > 0 ? len : 1, sizeof(int));
+    double waiting_time = 0, response_time = 0;
+    int next = 0, finished = 0, queued = 0, next_boost = boost;
+
+    for (int l = 0; l < levels; l++) {
+        queues[l].items = malloc(sizeof(int) * (len > 0 ? len : 1));
+        queues[l].head = queues[l].size = 0;
+        queues[l].capacity = len > 0 ? len : 1;
+    }
+    for (int i = 0; i < len; i++)
+        burst_time[i] = p_array[i].Burst_Time;
+
+    while (finished != len) {
+
+        if (boost > 0 && time >= next_boost) { /* Priority boost: everyone back to the top */
+            for (int l = 1; l < levels; l++) {
+                while (queues[l].size) {
+                    int i = fifo_pop(&queues[l]);
+                    level[i] = used[i] = 0;
+                    fifo_push(&queues[0], i);
+                }
+            }
+            next_boost = (time / boost + 1) * boost;
+        }
+
+        if (queued == 0 && (p_array[next].Arrival_Time - time) > 0) { /* Check for idle CPU time */
+            idle_burst(p_array[next].Arrival_Time - time);
+            time = p_array[next].Arrival_Time;
+        }
+
+        while (next < len && p_array[next].Arrival_Time <= time) { /* Admit arrived processes */
+            fifo_push(&queues[0], next++);
+            queued++;
+        }
+
+        int l = 0;
+        while (queues[l].size == 0)
+            l++;
+
+        int i = fifo_pop(&queues[l]);
+        P * p = &p_array[i];
+        int slice = min(p->Remaining_Time, quanta[l] - used[i]);
+        queued--;
+
+        if (!started[i]) {
+            started[i] = 1;
+            response_time += time - p->Arrival_Time;
+        }
+
+        if (l > 0 && next < len && p_array[next].Arrival_Time < time + slice)
+            slice = p_array[next].Arrival_Time - time; /* Preempted by a top-level arrival */
+
+        p->Burst_Time = slice;
+        simulate_cpu_burst(p);
+        time += slice;
+        used[i] += slice;
+
+        if (p->Remaining_Time == 0) {
+            finished++;
+            waiting_time += time - p->Arrival_Time - burst_time[i];
+            continue;
+        }
+
+        if (used[i] == quanta[l]) { /* Allotment used up: demote */
+            level[i] = min(l + 1, levels - 1);
+            used[i] = 0;
+        }
+        fifo_push(&queues[level[i]], i);
+        queued++;
+    }
+
+    for (int i = 0; i < len; i++)
+        p_array[i].Burst_Time = burst_time[i];
+    for (int l = 0; l < levels; l++)
+        free(queues[l].items);
+
+    free(level);
+    free(used);
+    free(burst_time);
+    free(started);
+
+    *avg_RT = len ? response_time / len : 0;
+    return len ? waiting_time / len : 0;
+}
+
+/* CFS load weight of nice -20 .. 19 (Linux sched_prio_to_weight), nice 0 = 1024 */
+const int nice_to_weight[40] = {
+    88761, 71755, 56483, 46273, 36291, 29154, 23254, 18705, 14949, 11916,
+     9548,  7620,  6100,  4904,  3906,  3121,  2501,  1991,  1586,  1277,
+     1024,   820,   655,   526,   423,   335,   272,   215,   172,   137,
+      110,    87,    70,    56,    45,    36,    29,    23,    18,    15
+};
+
+/**
+ * @brief Red-black tree of process indices ordered by key (CFS virtual
+ *        runtime), ties broken by index. Node n of the arrays is process n;
+ *        node `nil` is the shared black sentinel.
+ */
+typedef struct rb_tree {
+    int root, nil;
+    int * left, * right, * parent;
+    char * red;
+    unsigned long * key;
+} rb_tree;
+
+/**
+ * @brief Creates an empty tree for processes 0 .. len-1
+ */
+rb_tree rb_create(int len) {
+    rb_tree t;
+    t.nil = t.root = len;
+    t.left = malloc(sizeof(int) * (len + 1));
+    t.right = malloc(sizeof(int) * (len + 1));
+    t.parent = malloc(sizeof(int) * (len + 1));
+    t.red = calloc(len + 1, 1);
+    t.key = calloc(len + 1, sizeof(unsigned long));
+    return t;
+}
+
+/**
+ * @brief Frees a tree
+ */
+void rb_free(rb_tree * t) {
+    free(t->left);
+    free(t->right);
+    free(t->parent);
+    free(t->red);
+    free(t->key);
+}
+
+/**
+ * @brief Returns 1 if node a orders before node b
+ */
+int rb_less(rb_tree * t, int a, int b) {
+    if (t->key[a] != t->key[b]) return t->key[a] < t->key[b];
+    return a < b;
+}
+
+/**
+ * @brief Rotates the subtree at x to the left
+ */
+void rb_rotate_left(rb_tree * t, int x) {
+    int y = t->right[x];
+    t->right[x] = t->left[y];
+    if (t->left[y] != t->nil) t->parent[t->left[y]] = x;
+    t->parent[y] = t->parent[x];
+    if (t->parent[x] == t->nil) t->root = y;
+    else if (x == t->left[t->parent[x]]) t->left[t->parent[x]] = y;
+    else t->right[t->parent[x]] = y;
+    t->left[y] = x;
+    t->parent[x] = y;
+}
+
+/**
+ * @brief Rotates the subtree at x to the right
+ */
+void rb_rotate_right(rb_tree * t, int x) {
+    int y = t->left[x];
+    t->left[x] = t->right[y];
+    if (t->right[y] != t->nil) t->parent[t->right[y]] = x;
+    t->parent[y] = t->parent[x];
+    if (t->parent[x] == t->nil) t->root = y;
+    else if (x == t->right[t->parent[x]]) t->right[t->parent[x]] = y;
+    else t->left[t->parent[x]] = y;
+    t->right[y] = x;
+    t->parent[x] = y;
+}
+
+/**
+ * @brief Inserts node z with its current key (O(log n))
+ */
+void rb_insert(rb_tree * t, int z) {
+    int y = t->nil, x = t->root;
+
+    while (x != t->nil) {
+        y = x;
+        x = rb_less(t, z, x) ? t->left[x] : t->right[x];
+    }
+    t->parent[z] = y;
+    if (y == t->nil) t->root = z;
+    else if (rb_less(t, z, y)) t->left[y] = z;
+    else t->right[y] = z;
+    t->left[z] = t->right[z] = t->nil;
+    t->red[z] = 1;
+
+    while (t->red[t->parent[z]]) { /* Restore the red-black properties */
+        int p = t->parent[z], g = t->parent[p];
+        if (p == t->left[g]) {
+            int u = t->right[g];
+            if (t->red[u]) {
+                t->red[p] = t->red[u] = 0;
+                t->red[g] = 1;
+                z = g;
+            } else {
+                if (z == t->right[p]) {
+                    z = p;
+                    rb_rotate_left(t, z);
+                    p = t->parent[z];
+                }
+                t->red[p] = 0;
+                t->red[g] = 1;
+                rb_rotate_right(t, g);
+            }
+        } else {
+            int u = t->left[g];
+            if (t->red[u]) {
+                t->red[p] = t->red[u] = 0;
+                t->red[g] = 1;
+                z = g;
+            } else {
+                if (z == t->left[p]) {
+                    z = p;
+                    rb_rotate_right(t, z);
+                    p = t->parent[z];
+                }
+                t->red[p] = 0;
+                t->red[g] = 1;
+                rb_rotate_left(t, g);
+            }
+        }
+    }
+    t->red[t->root] = 0;
+}
+
+/**
+ * @brief Replaces the subtree at u with the subtree at v
+ */
+void rb_transplant(rb_tree * t, int u, int v) {
+    if (t->parent[u] == t->nil) t->root = v;
+    else if (u == t->left[t->parent[u]]) t->left[t->parent[u]] = v;
+    else t->right[t->parent[u]] = v;
+    t->parent[v] = t->parent[u];
+}
+
+/**
+ * @brief Returns the leftmost node of the subtree at x
+ */
+int rb_minimum(rb_tree * t, int x) {
+    while (t->left[x] != t->nil)
+        x = t->left[x];
+    return x;
+}
+
+/**
+ * @brief Removes node z (O(log n))
+ */
+void rb_erase(rb_tree * t, int z) {
+    int y = z, x, y_red = t->red[z];
+
+    if (t->left[z] == t->nil) {
+        x = t->right[z];
+        rb_transplant(t, z, t->right[z]);
+    } else if (t->right[z] == t->nil) {
+        x = t->left[z];
+        rb_transplant(t, z, t->left[z]);
+    } else {
+        y = rb_minimum(t, t->right[z]);
+        y_red = t->red[y];
+        x = t->right[y];
+        if (t->parent[y] == z) {
+            t->parent[x] = y;
+        } else {
+            rb_transplant(t, y, t->right[y]);
+            t->right[y] = t->right[z];
+            t->parent[t->right[y]] = y;
+        }
+        rb_transplant(t, z, y);
+        t->left[y] = t->left[z];
+        t->parent[t->left[y]] = y;
+        t->red[y] = t->red[z];
+    }
+
+    if (y_red)
+        return;
+
+    while (x != t->root && !t->red[x]) { /* Restore the red-black properties */
+        int p = t->parent[x];
+        if (x == t->left[p]) {
+            int w = t->right[p];
+            if (t->red[w]) {
+                t->red[w] = 0;
+                t->red[p] = 1;
+                rb_rotate_left(t, p);
+                w = t->right[p];
+            }
+            if (!t->red[t->left[w]] && !t->red[t->right[w]]) {
+                t->red[w] = 1;
+                x = p;
+            } else {
+                if (!t->red[t->right[w]]) {
+                    t->red[t->left[w]] = 0;
+                    t->red[w] = 1;
+                    rb_rotate_right(t, w);
+                    w = t->right[p];
+                }
+                t->red[w] = t->red[p];
+                t->red[p] = t->red[t->right[w]] = 0;
+                rb_rotate_left(t, p);
+                x = t->root;
+            }
+        } else {
+            int w = t->left[p];
+            if (t->red[w]) {
+                t->red[w] = 0;
+                t->red[p] = 1;
+                rb_rotate_right(t, p);
+                w = t->left[p];
+            }
+            if (!t->red[t->right[w]] && !t->red[t->left[w]]) {
+                t->red[w] = 1;
+                x = p;
+            } else {
+                if (!t->red[t->left[w]]) {
+                    t->red[t->right[w]] = 0;
+                    t->red[w] = 1;
+                    rb_rotate_left(t, w);
+                    w = t->left[p];
+                }
+                t->red[w] = t->red[p];
+                t->red[p] = t->red[t->left[w]] = 0;
+                rb_rotate_right(t, p);
+                x = t->root;
+            }
+        }
+    }
+    t->red[x] = 0;
+}
+
+/**
+ * @brief Simulates a CFS-like fair scheduler. Runnable processes sit in a
+ *        red-black tree keyed by virtual runtime; the leftmost runs for a
+ *        slice of the target latency proportional to its weight (at least
+ *        the minimum granularity), and its virtual runtime grows by the slice
+ *        scaled by 1024 / weight. The weight comes from Priority as a nice
+ *        value (clamped to -20 .. 19). Arrivals start at the minimum virtual
+ *        runtime and wait for the running slice to end.
+ * @param p_array Array of processes, sorted by arrival time
+ * @param len Length of the process array
+ * @param latency Target latency
+ * @param min_granularity Minimum slice
+ * @param avg_RT Set to the average response time
+ * @return Average waiting time of all processes
+ */
+double run_cfs(P p_array[], int len, int latency, int min_granularity, double * avg_RT) {
+
+    rb_tree tree = rb_create(len);
+    int * weight = malloc(sizeof(int) * (len > 0 ? len : 1));
+    int * burst_time = malloc(sizeof(int) * (len > 0 ? len : 1));
+    int * started = calloc(len > 0 ? len : 1, sizeof(int));
+    unsigned long min_vruntime = 0;
+    long total_weight = 0; /* of all runnable processes */
+    double waiting_time = 0, response_time = 0;
+    int next = 0, finished = 0;
+
+    for (int i = 0; i < len; i++) {
+        burst_time[i] = p_array[i].Burst_Time;
+        weight[i] = nice_to_weight[max(-20, min(19, p_array[i].Priority)) + 20];
+    }
+
+    while (finished != len) {
+
+        if (tree.root == tree.nil && (p_array[next].Arrival_Time - time) > 0) { /* Check for idle CPU time */
+            idle_burst(p_array[next].Arrival_Time - time);
+            time = p_array[next].Arrival_Time;
+        }
+
+        while (next < len && p_array[next].Arrival_Time <= time) { /* Admit arrived processes */
+            if (p_array[next].Remaining_Time <= 0) { /* Nothing to run: retire it on arrival */
+                reap_child(&p_array[next]);
+                started[next] = 1;
+                response_time += time - p_array[next].Arrival_Time;
+                waiting_time += time - p_array[next].Arrival_Time;
+                finished++;
+                next++;
+                continue;
+            }
+            tree.key[next] = min_vruntime;
+            total_weight += weight[next];
+            rb_insert(&tree, next++);
+        }
+
+        if (tree.root == tree.nil) /* Only zero-burst processes arrived */
+            continue;
+
+        int i = rb_minimum(&tree, tree.root);
+        P * p = &p_array[i];
+        rb_erase(&tree, i);
+
+        if (!started[i]) {
+            started[i] = 1;
+            response_time += time - p->Arrival_Time;
+        }
+
+        int slice = max(min_granularity, (int)((long)latency * weight[i] / total_weight));
+        slice = min(max(1, slice), p->Remaining_Time);
+
+        p->Burst_Time = slice;
+        simulate_cpu_burst(p);
+        time += slice;
+        tree.key[i] += ((unsigned long)slice << 20) / weight[i]; /* slice * 1024 / weight, << 10 */
+
+        if (p->Remaining_Time == 0) {
+            finished++;
+            total_weight -= weight[i];
+            waiting_time += time - p->Arrival_Time - burst_time[i];
+        } else {
+            rb_insert(&tree, i);
+        }
+
+        if (tree.root != tree.nil) {
+            unsigned long leftmost = tree.key[rb_minimum(&tree, tree.root)];
+            if (leftmost > min_vruntime) min_vruntime = leftmost;
+        }
+    }
+
+    for (int i = 0; i < len; i++)
+        p_array[i].Burst_Time = burst_time[i];
+
+    free(weight);
+    free(burst_time);
+    free(started);
+    rb_free(&tree);
+
+    *avg_RT = len ? response_time / len : 0;
+    return len ? waiting_time / len : 0;
+}
+
+/**
+ * @brief Returns 1 if process p may run on CPU c
+ */
+int allowed_on(const P * p, int c) {
+    return p->Affinity < 0 || p->Affinity == c;
+}
+
+/**
+ * @brief Appends process i to the run queue of a CPU
+ */
+void cpu_enqueue(cpu * c, int * next_in_queue, int i) {
+    next_in_queue[i] = -1;
+    if (c->queued++) next_in_queue[c->tail] = i;
+    else c->head = i;
+    c->tail = i;
+}
+
+/**
+ * @brief Removes the first process of a run queue that may run on CPU dest
+ * @return Index of the process, or -1 if there is none
+ */
+int cpu_dequeue(cpu * c, int * next_in_queue, P p_array[], int dest) {
+    int prev = -1;
+
+    for (int i = c->head; c->queued && i != -1; prev = i, i = next_in_queue[i]) {
+        if (!allowed_on(&p_array[i], dest))
+            continue;
+
+        if (prev == -1) c->head = next_in_queue[i];
+        else next_in_queue[prev] = next_in_queue[i];
+        if (i == c->tail) c->tail = prev;
+        c->queued--;
+        return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief Starts a slice of a child process on a CPU (REAL_TIME only).
+ *        The child is pinned to the matching host CPU before it continues.
+ */
+void start_slice(P * p, int c) {
+    if (mode == VIRTUAL_TIME)
+        return;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(c % sysconf(_SC_NPROCESSORS_ONLN), &set);
+    sched_setaffinity(p->pid, sizeof(set), &set);
+    kill(p->pid, SIGCONT);
+}
+
+/**
+ * @brief Ends a slice of a child process, killing it when it finished (REAL_TIME only)
+ */
+void stop_slice(P * p) {
+    if (mode == VIRTUAL_TIME)
+        return;
+
+    if (p->Remaining_Time == 0) {
+        kill(p->pid, SIGKILL);
+        waitpid(p->pid, NULL, 0);
+    } else {
+        kill(p->pid, SIGSTOP);
+    }
+}
+
+/**
+ * @brief Simulates Round Robin on several CPUs. Every CPU has its own run
+ *        queue; an arrival joins the least loaded CPU it may run on, a slice
+ *        that ends goes back to the tail of its CPU's queue, and a CPU whose
+ *        queue is empty steals the longest waiting process it may run from
+ *        the busiest queue. The clock jumps from event to event (arrival or
+ *        end of a slice); in REAL_TIME the children run concurrently.
+ * @param p_array Array of processes, sorted by arrival time
+ * @param len Length of the process array
+ * @param cpus Number of CPUs
+ * @param cpu_state Per-CPU state, filled in for the report
+ * @param time_quantum Time quantum of each slice
+ * @param avg_RT Set to the average response time
+ * @return Average waiting time of all processes
+ */
+double run_smp(P p_array[], int len, int cpus, cpu cpu_state[], int time_quantum, double * avg_RT) {
+
+    int * next_in_queue = malloc(sizeof(int) * (len > 0 ? len : 1));
+    int * started = calloc(len > 0 ? len : 1, sizeof(int));
+    double waiting_time = 0, response_time = 0;
+    int next = 0, finished = 0;
+
+    for (int c = 0; c < cpus; c++) {
+        cpu_state[c] = (cpu){.running = -1, .head = -1, .tail = -1};
+    }
+
+    while (finished != len) {
+
+        int event = next < len ? p_array[next].Arrival_Time : -1; /* next event time */
+        for (int c = 0; c < cpus; c++) {
+            if (cpu_state[c].running >= 0 && (event < 0 || cpu_state[c].slice_end < event))
+                event = cpu_state[c].slice_end;
+        }
+        if (event > time) {
+            if (mode == REAL_TIME) wait_time_units(event - time);
+            time = event;
+        }
+
+        for (int c = 0; c < cpus; c++) { /* End the slices that are due */
+            cpu * cp = &cpu_state[c];
+            if (cp->running < 0 || cp->slice_end != time)
+                continue;
+
+            P * p = &p_array[cp->running];
+            p->Remaining_Time -= time - cp->slice_start;
+            cp->busy += time - cp->slice_start;
+            stop_slice(p);
+
+            snprintf(buf, sizeof(buf), "%d → %d: CPU %d: %s Running %s.\n", cp->slice_start, time, c,
+                string_at(p->Name), string_at(p->Description));
+            output_to_screen();
+
+            if (p->Remaining_Time == 0) {
+                finished++;
+                waiting_time += time - p->Arrival_Time - p->Burst_Time;
+            } else {
+                cpu_enqueue(cp, next_in_queue, cp->running);
+            }
+            cp->running = -1;
+        }
+
+        while (next < len && p_array[next].Arrival_Time <= time) { /* Least loaded allowed CPU */
+            int best = -1, best_load = 0;
+            for (int c = 0; c < cpus; c++) {
+                int load = cpu_state[c].queued + (cpu_state[c].running >= 0);
+                if (allowed_on(&p_array[next], c) && (best < 0 || load < best_load)) {
+                    best = c;
+                    best_load = load;
+                }
+            }
+            cpu_enqueue(&cpu_state[best], next_in_queue, next++);
+        }
+
+        /* Dispatch on idle CPUs: every CPU serves its own queue first, then the
+           CPUs still idle steal */
+        for (int steal = 0; steal < 2; steal++) {
+            for (int c = 0; c < cpus; c++) {
+                cpu * cp = &cpu_state[c];
+                if (cp->running >= 0)
+                    continue;
+
+                int i = steal ? -1 : cpu_dequeue(cp, next_in_queue, p_array, c);
+
+                unsigned long tried = 1UL << c;
+                while (steal && i < 0) { /* Work stealing, busiest queue first */
+                    int victim = -1;
+                    for (int v = 0; v < cpus; v++) {
+                        if (!(tried >> v & 1) && cpu_state[v].queued
+                            && (victim < 0 || cpu_state[v].queued > cpu_state[victim].queued))
+                            victim = v;
+                    }
+                    if (victim < 0)
+                        break;
+
+                    tried |= 1UL << victim;
+                    if ((i = cpu_dequeue(&cpu_state[victim], next_in_queue, p_array, c)) >= 0)
+                        cp->steals++;
+                }
+                if (i < 0)
+                    continue;
+
+                P * p = &p_array[i];
+                if (!started[i]) {
+                    started[i] = 1;
+                    response_time += time - p->Arrival_Time;
+                }
+
+                cp->running = i;
+                cp->slice_start = time;
+                cp->slice_end = time + (p->Remaining_Time ? max(1, min(time_quantum, p->Remaining_Time)) : 0);
+                cp->slices++;
+                start_slice(p, c);
+            }
+        }
     }
+
+    free(next_in_queue);
+    free(started);
+
+    *avg_RT = len ? response_time / len : 0;
+    return len ? waiting_time / len : 0;
 }
+
 /**
  * @brief Runs the First-Come-First-Serve (FCFS) scheduling algorithm
  * @param p_array Array of processes
@@ -451,7 +1573,7 @@ void FCFS(P p_array[], int len) {
 
     create_child_proccess(p_array, len);
 
-    float avg_WT = run_non_preemptive(p_array, len);
+    double avg_WT = run_non_preemptive(p_array, len);
 
     print_np_closing(avg_WT);
 }
@@ -466,11 +1588,10 @@ void SJF(P p_array[], int len) {
     time = 0;
     print_opening("SJF");
 
-    sort(p_array, len, SHORTEST_JOB);
-    sort_by_prop(p_array, len);
+    sort(p_array, len, ARRIVAL);
 
     create_child_proccess(p_array, len);
-    float avg_WT = run_non_preemptive(p_array, len);
+    double avg_WT = run_ready_queue(p_array, len, before_shortest_job);
 
     print_np_closing(avg_WT);
 }
@@ -485,15 +1606,135 @@ void PS(P p_array[], int len) {
     time = 0;
     print_opening("Priority");
 
-    sort(p_array, len, PRIORITY);
-    sort_by_prop(p_array, len);
+    sort(p_array, len, ARRIVAL);
 
     create_child_proccess(p_array, len);
-    float avg_WT = run_non_preemptive(p_array, len);
+    double avg_WT = run_ready_queue(p_array, len, before_priority);
 
     print_np_closing(avg_WT);
 }
 
+/**
+ * @brief Runs the Shortest Remaining Time First (SRTF) preemptive scheduling algorithm
+ * @param p_array Array of processes
+ * @param len Length of the process array
+ */
+void SRTF(P p_array[], int len) {
+
+    time = 0;
+    print_opening("SRTF");
+
+    sort(p_array, len, ARRIVAL);
+
+    create_child_proccess(p_array, len);
+    double avg_RT;
+    double avg_WT = run_preemptive_queue(p_array, len, before_shortest_remaining, &avg_RT);
+
+    print_pq_closing(avg_WT, avg_RT);
+}
+
+/**
+ * @brief Runs the Priority preemptive scheduling algorithm
+ * @param p_array Array of processes
+ * @param len Length of the process array
+ */
+void PPS(P p_array[], int len) {
+
+    time = 0;
+    print_opening("Preemptive Priority");
+
+    sort(p_array, len, ARRIVAL);
+
+    create_child_proccess(p_array, len);
+    double avg_RT;
+    double avg_WT = run_preemptive_queue(p_array, len, before_priority, &avg_RT);
+
+    print_pq_closing(avg_WT, avg_RT);
+}
+
+/**
+ * @brief Runs the multilevel feedback queue (MLFQ) scheduling algorithm.
+ *        Without set_mlfq, three levels with allotments of 1, 2 and 4 quanta
+ *        and a boost every 20 quanta.
+ * @param p_array Array of processes
+ * @param len Length of the process array
+ * @param time_quantum Quantum of the top level when MLFQ is not configured
+ */
+void MLFQ(P p_array[], int len, int time_quantum) {
+
+    int levels = mlfq_levels, boost = mlfq_boost;
+    int quanta[MLFQ_MAX_LEVELS];
+
+    if (levels == 0) {
+        levels = 3;
+        boost = 20 * time_quantum;
+        for (int l = 0; l < levels; l++)
+            quanta[l] = time_quantum << l;
+    } else {
+        for (int l = 0; l < levels; l++)
+            quanta[l] = mlfq_quanta[l];
+    }
+
+    time = 0;
+    print_opening("MLFQ");
+
+    sort(p_array, len, ARRIVAL);
+
+    create_child_proccess(p_array, len);
+    double avg_RT;
+    double avg_WT = run_mlfq(p_array, len, levels, quanta, boost, &avg_RT);
+
+    print_pq_closing(avg_WT, avg_RT);
+}
+
+/**
+ * @brief Runs the CFS-like fair scheduling algorithm. Without set_cfs, the
+ *        target latency is 4 quanta and the minimum granularity one quantum.
+ * @param p_array Array of processes
+ * @param len Length of the process array
+ * @param time_quantum Quantum the defaults are derived from
+ */
+void CFS(P p_array[], int len, int time_quantum) {
+
+    int latency = cfs_latency ? cfs_latency : 4 * time_quantum;
+    int min_granularity = cfs_min_granularity ? cfs_min_granularity : time_quantum;
+
+    time = 0;
+    print_opening("CFS");
+
+    sort(p_array, len, ARRIVAL);
+
+    create_child_proccess(p_array, len);
+    double avg_RT;
+    double avg_WT = run_cfs(p_array, len, latency, min_granularity, &avg_RT);
+
+    print_pq_closing(avg_WT, avg_RT);
+}
+
+/**
+ * @brief Runs Round Robin on num_cpus CPUs with per-CPU run queues and work stealing
+ * @param p_array Array of processes
+ * @param len Length of the process array
+ * @param time_quantum Time quantum for each CPU burst
+ */
+void SMP(P p_array[], int len, int time_quantum) {
+
+    cpu cpu_state[MAX_CPUS];
+    char title[64];
+
+    time = 0;
+    sprintf(title, "SMP Round Robin (%d CPUs)", num_cpus);
+    print_opening(title);
+
+    sort(p_array, len, ARRIVAL);
+
+    create_child_proccess(p_array, len);
+    double avg_RT;
+    double avg_WT = run_smp(p_array, len, num_cpus, cpu_state, time_quantum, &avg_RT);
+
+    print_smp_closing(cpu_state, num_cpus, time, avg_WT, avg_RT);
+}
+
 /**
  * @brief Runs the Round Robin (RR) preemptive scheduling algorithm
  * @param p_array Array of processes
@@ -527,28 +1768,116 @@ void copy_array(P p_array[], P copy[], int len) {
     }
 }
 
+/**
+ * @brief Selects how bursts are simulated by runCPUScheduler.
+ *        REAL_TIME (default) runs a stopped child per process and waits for
+ *        each burst with an interval timer; VIRTUAL_TIME forks nothing and
+ *        advances the global clock from one event (arrival or end of burst)
+ *        to the next without sleeping. Both print the same timeline and
+ *        summaries.
+ * @param m Execution mode
+ */
+void set_execution_mode(exec_mode m) {
+    mode = m;
+}
+
+/**
+ * @brief Sets the length of one time unit in REAL_TIME mode. Arrival times,
+ *        bursts and the Round Robin quantum are all counted in time units, so
+ *        set_time_unit(1000) turns a quantum of 5 into 5 ms.
+ * @param us Microseconds per time unit (default 1000000, one second)
+ */
+void set_time_unit(long us) {
+    time_unit_us = us;
+}
+
+/**
+ * @brief Configures the MLFQ levels used by runCPUScheduler
+ * @param levels Number of levels (1 .. MLFQ_MAX_LEVELS)
+ * @param quanta Time allotment of each level, top level first (all > 0)
+ * @param boost Priority boost period in time units (0 = never)
+ * @return 0 on success, -1 on an invalid configuration
+ */
+int set_mlfq(int levels, const int quanta[], int boost) {
+
+    if (levels < 1 || levels > MLFQ_MAX_LEVELS || boost < 0) {
+        fprintf(stderr, "invalid MLFQ configuration\n");
+        return -1;
+    }
+    for (int l = 0; l < levels; l++) {
+        if (quanta[l] <= 0) {
+            fprintf(stderr, "invalid MLFQ quantum at level %d\n", l);
+            return -1;
+        }
+        mlfq_quanta[l] = quanta[l];
+    }
+
+    mlfq_levels = levels;
+    mlfq_boost = boost;
+    return 0;
+}
+
+/**
+ * @brief Configures the CFS-like scheduler used by runCPUScheduler
+ * @param latency Target latency in time units: every runnable process runs once per period
+ * @param min_granularity Minimum slice in time units
+ * @return 0 on success, -1 on an invalid configuration
+ */
+int set_cfs(int latency, int min_granularity) {
+
+    if (latency <= 0 || min_granularity <= 0) {
+        fprintf(stderr, "invalid CFS configuration\n");
+        return -1;
+    }
+
+    cfs_latency = latency;
+    cfs_min_granularity = min_granularity;
+    return 0;
+}
+
+/**
+ * @brief Sets the number of simulated CPUs. With more than one, runCPUScheduler
+ *        also runs the SMP Round Robin scheduler.
+ * @param cpus Number of CPUs (1 .. MAX_CPUS)
+ * @return 0 on success, -1 if out of range
+ */
+int set_cpus(int cpus) {
+
+    if (cpus < 1 || cpus > MAX_CPUS) {
+        fprintf(stderr, "invalid number of CPUs\n");
+        return -1;
+    }
+
+    num_cpus = cpus;
+    return 0;
+}
+
 /**
  * @brief Runs all CPU scheduling algorithms on the processes in a CSV file.
- *        Executes FCFS, SJF, Priority, and Round Robin algorithms.
+ *        Executes FCFS, SJF, Priority, SRTF, preemptive Priority, MLFQ, CFS,
+ *        SMP Round Robin (with set_cpus), and Round Robin algorithms.
  * @param processesCsvFilePath Path to the CSV file containing process data
  * @param time_quantum Time quantum to be used for the Round Robin algorithm
  */
 void runCPUScheduler(char* processesCsvFilePath, int time_quantum) {
 
-    P p_array[1001], copy[1001];
+    P * p_array, * copy;
     int len;
 
     /* Fill the processes array from the CSV file */
-    len = fill_processes_array(processesCsvFilePath, p_array);
-    
+    len = fill_processes_array(processesCsvFilePath, &p_array);
+
     /* Make a copy for preemptive scheduling */
+    copy = malloc(sizeof(P) * (len > 0 ? len : 1));
     copy_array(p_array, copy, len);
     
-    /* Block all signals except SIGALRM */
-    block_all_signal();
+    if (mode == REAL_TIME) {
+        /* Block all signals except SIGALRM */
+        block_all_signal();
 
-    /* Set the SIGALRM and SIGUSR1 handlers */
-    set_alarm_handler();
+        /* Set the SIGALRM and SIGUSR1 handlers */
+        set_alarm_handler();
+    }
     
     /* Run non-preemptive algorithms */
     FCFS(p_array, len);
@@ -563,6 +1892,33 @@ void runCPUScheduler(char* processesCsvFilePath, int time_quantum) {
     sprintf(buf, "\n");
     output_to_screen();
 
+    /* Run preemptive queue-based algorithms */
+    SRTF(p_array, len);
+    sprintf(buf, "\n");
+    output_to_screen();
+
+    PPS(p_array, len);
+    sprintf(buf, "\n");
+    output_to_screen();
+
+    MLFQ(p_array, len, time_quantum);
+    sprintf(buf, "\n");
+    output_to_screen();
+
+    CFS(p_array, len, time_quantum);
+    sprintf(buf, "\n");
+    output_to_screen();
+
+    if (num_cpus > 1) { /* Run the multi-core scheduler */
+        SMP(p_array, len, time_quantum);
+        sprintf(buf, "\n");
+        output_to_screen();
+    }
+
     /* Run preemptive Round Robin algorithm */
     RR(copy, len, time_quantum);
+
+    free(p_array);
+    free(copy);
+    free_arena(&strings);
 }
@@ -0,0 +1,420 @@
+#include "cache.h"
+#include "policy.h"
+#include "specialize.h"
+#include "stats.h"
+#include "tagmatch.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_SETS 4096      // Sets probed per benchmark (fits in the host LLC)
+#define BENCH_PROBES 4000000 // Probes timed per kernel and associativity
+#define BENCH_SEED 12345     // Fixed seed so runs are reproducible
+#define BENCH_ACCESSES 4000000 // read_byte calls timed per geometry
+#define BENCH_GEOMETRY_SETS 7  // s of the geometry benchmark (128 sets)
+#define BENCH_WORKING_SET 4    // Pattern working set, in multiples of the cache size
+#define BENCH_WRITE_EVERY 4    // Every 4th pattern access is a write_byte
+#define BENCH_ZIPF_ALPHA 0.99  // Skew of the Zipfian pattern
+#define BENCH_RUNS 3           // Timed runs per pattern, the fastest is reported
+
+volatile long bench_sink; // Consumes results so timed loops are not optimized away
+
+/**
+ * @brief Returns the current monotonic time in nanoseconds.
+ */
+double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * @brief xorshift64 pseudo random generator.
+ * @param state Generator state (non-zero)
+ * @return Next pseudo random value
+ */
+unsigned long next_random(unsigned long* state) {
+    unsigned long x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+/**
+ * @brief Times one kernel on a full-set probe: tag match, then victim search on a miss.
+ * @param tags BENCH_SETS tag arrays of E entries
+ * @param frequency BENCH_SETS frequency arrays of E entries
+ * @param queries Probe sequence of (set, tag) pairs
+ * @param E Associativity
+ * @param checksum Accumulates results so the work is not optimized away
+ * @return Nanoseconds per probe
+ */
+double time_probe(long* tags, uchar* frequency, long* queries, int E, long* checksum) {
+
+    double begin = now_ns();
+
+    for (int i = 0; i < BENCH_PROBES; i++) {
+        long set = queries[2 * i];
+        long tag = queries[2 * i + 1];
+
+        int line = find_tag(tags + set * E, E, tag);
+        if (line < 0) {
+            line = find_min_frequency(frequency + set * E, E);
+        }
+        *checksum += line;
+    }
+
+    return (now_ns() - begin) / BENCH_PROBES;
+}
+
+/**
+ * @brief Tag match benchmark: ns per set probe for every kernel across E = 1..64.
+ *
+ * Every set is full of distinct random tags and half the probes hit, at a
+ * uniformly random way, so both the match and the victim search are exercised.
+ */
+void bench_tagmatch() {
+
+    int ways[] = {1, 2, 4, 6, 8, 12, 16, 24, 32, 48, 64};
+    int n_ways = sizeof(ways) / sizeof(ways[0]);
+    tag_kernel_t kernels[] = {KERNEL_SCALAR, KERNEL_SSE2, KERNEL_AVX2};
+    int n_kernels = sizeof(kernels) / sizeof(kernels[0]);
+
+    long* tags = malloc(sizeof(long) * BENCH_SETS * 64);
+    uchar* frequency = malloc(BENCH_SETS * 64);
+    long* queries = malloc(sizeof(long) * 2 * BENCH_PROBES);
+
+    printf("%-4s", "E");
+    for (int k = 0; k < n_kernels; k++) {
+        printf(" %9s", tag_kernel_name(kernels[k]));
+    }
+    printf(" %9s\n", "speedup");
+
+    for (int w = 0; w < n_ways; w++) {
+        int E = ways[w];
+        unsigned long rng = BENCH_SEED;
+        long checksum = 0;
+
+        // Tags are unique within a set: a random high part plus the way number
+        for (long i = 0; i < (long)BENCH_SETS * E; i++) {
+            tags[i] = (long)((next_random(&rng) >> 8) & ~63UL) | (i % E);
+            frequency[i] = (uchar)next_random(&rng);
+        }
+
+        for (int i = 0; i < BENCH_PROBES; i++) {
+            long set = next_random(&rng) % BENCH_SETS;
+            long way = next_random(&rng) % E;
+            queries[2 * i] = set;
+            queries[2 * i + 1] = (next_random(&rng) & 1) ? tags[set * E + way] : -2 - way;
+        }
+
+        double scalar = 0, best = 1e9;
+        printf("%-4d", E);
+
+        for (int k = 0; k < n_kernels; k++) {
+            if (use_tag_kernel(kernels[k]) == -1) {
+                printf(" %9s", "n/a");
+                continue;
+            }
+
+            double ns = time_probe(tags, frequency, queries, E, &checksum);
+            if (kernels[k] == KERNEL_SCALAR) scalar = ns;
+            if (ns < best) best = ns;
+            printf(" %7.2fns", ns);
+        }
+
+        printf(" %8.2fx\n", scalar / best);
+        bench_sink += checksum;
+    }
+
+    select_tag_kernel();
+    free(tags);
+    free(frequency);
+    free(queries);
+}
+
+/**
+ * @brief Times read_byte over a fixed address sequence.
+ * @param cache The cache (generic or specialized)
+ * @param mem Simulated main memory
+ * @param addrs Address sequence of BENCH_ACCESSES entries
+ * @return Nanoseconds per access
+ */
+double time_reads(cache_t cache, uchar* mem, long* addrs) {
+
+    long checksum = 0;
+    double begin = now_ns();
+
+    for (int i = 0; i < BENCH_ACCESSES; i++) {
+        checksum += read_byte(cache, mem, addrs[i]);
+    }
+
+    bench_sink += checksum;
+    return (now_ns() - begin) / BENCH_ACCESSES;
+}
+
+/**
+ * @brief Geometry specialization benchmark: ns per read_byte with the generic
+ *        and the unrolled probe/fill, for 64-byte blocks and 4/8/16 ways.
+ *
+ * The working set is twice the cache, so hits, cold misses and conflict
+ * misses (with their block fills) all occur.
+ */
+void bench_geometry() {
+
+    int ways[] = {4, 8, 16};
+    int s = BENCH_GEOMETRY_SETS, b = 6, t = 4;
+    long mem_size = 1L << (s + t + b);
+
+    uchar* mem = malloc(mem_size);
+    long* addrs = malloc(sizeof(long) * BENCH_ACCESSES);
+
+    for (long i = 0; i < mem_size; i++) {
+        mem[i] = (uchar)i;
+    }
+
+    printf("\n%-4s %9s %11s %9s\n", "E", "generic", "specialized", "speedup");
+
+    for (int w = 0; w < 3; w++) {
+        int E = ways[w];
+        long working_set = (2L * E) << (s + b);
+        unsigned long rng = BENCH_SEED;
+
+        for (int i = 0; i < BENCH_ACCESSES; i++) {
+            addrs[i] = next_random(&rng) % working_set;
+        }
+
+        cache_t generic = initialize_cache_policy(s, t, b, E, &frequency_policy);
+        generalize_cache(&generic);
+        cache_t special = initialize_cache_policy(s, t, b, E, &frequency_policy);
+
+        // Best of three alternating runs, to damp frequency scaling and noise
+        double slow = 1e9, fast = 1e9, ns;
+        for (int run = 0; run < 3; run++) {
+            if ((ns = time_reads(generic, mem, addrs)) < slow) slow = ns;
+            if ((ns = time_reads(special, mem, addrs)) < fast) fast = ns;
+        }
+
+        printf("%-4d %7.2fns %9.2fns %8.2fx\n", E, slow, fast, slow / fast);
+    }
+
+    free(mem);
+    free(addrs);
+}
+
+/**
+ * @brief Returns a random permutation of 0 .. n-1 (Fisher-Yates).
+ * @param n Number of elements
+ * @param rng Generator state
+ * @param cycle Non-zero for a single cycle through all elements (Sattolo)
+ * @return Newly allocated permutation
+ */
+long* random_permutation(long n, unsigned long* rng, int cycle) {
+
+    long* perm = malloc(sizeof(long) * n);
+    for (long i = 0; i < n; i++) {
+        perm[i] = i;
+    }
+
+    for (long i = n - 1; i > 0; i--) {
+        long j = next_random(rng) % (cycle ? i : i + 1);
+        long tmp = perm[i];
+        perm[i] = perm[j];
+        perm[j] = tmp;
+    }
+
+    return perm;
+}
+
+/**
+ * @brief Fills addrs with one of the synthetic access patterns.
+ *
+ * Addresses stay below working_set. Block granular patterns touch a random
+ * byte of each block, so reads and writes do not always hit offset 0.
+ *
+ * @param pattern "sequential", "strided", "random", "zipfian" or "chase"
+ * @param addrs Address sequence of BENCH_ACCESSES entries
+ * @param working_set Bytes the pattern spans
+ * @param b Block offset bits of the cache
+ */
+void generate_pattern(const char* pattern, long* addrs, long working_set, uchar b) {
+
+    unsigned long rng = BENCH_SEED;
+    long blocks = working_set >> b;
+
+    if (strcmp(pattern, "sequential") == 0) {
+        // Byte after byte: one miss per block, then hits
+        for (int i = 0; i < BENCH_ACCESSES; i++) {
+            addrs[i] = i % working_set;
+        }
+    } else if (strcmp(pattern, "strided") == 0) {
+        // Three blocks apart, so consecutive accesses land in different sets; each pass
+        // through the working set moves one byte further into the blocks
+        long stride = 3L << b;
+        for (int i = 0; i < BENCH_ACCESSES; i++) {
+            addrs[i] = (i * stride + (i * stride / working_set)) % working_set;
+        }
+    } else if (strcmp(pattern, "random") == 0) {
+        for (int i = 0; i < BENCH_ACCESSES; i++) {
+            addrs[i] = next_random(&rng) % working_set;
+        }
+    } else if (strcmp(pattern, "zipfian") == 0) {
+        // Block of rank k is drawn with probability ~ 1 / k^alpha; ranks are scattered over the sets
+        double* cdf = malloc(sizeof(double) * blocks);
+        long* rank_to_block = random_permutation(blocks, &rng, 0);
+        double sum = 0;
+
+        for (long k = 0; k < blocks; k++) {
+            sum += 1.0 / pow(k + 1, BENCH_ZIPF_ALPHA);
+            cdf[k] = sum;
+        }
+
+        for (int i = 0; i < BENCH_ACCESSES; i++) {
+            double u = (next_random(&rng) >> 11) * (sum / 9007199254740992.0);
+            long lo = 0, hi = blocks - 1;
+            while (lo < hi) {
+                long mid = (lo + hi) / 2;
+                if (cdf[mid] < u) lo = mid + 1;
+                else hi = mid;
+            }
+            addrs[i] = (rank_to_block[lo] << b) | (next_random(&rng) & ((1L << b) - 1));
+        }
+
+        free(cdf);
+        free(rank_to_block);
+    } else {
+        // Pointer chase: follow a single random cycle through every block
+        long* next = random_permutation(blocks, &rng, 1);
+        long block = 0;
+
+        for (int i = 0; i < BENCH_ACCESSES; i++) {
+            addrs[i] = (block << b) | (next_random(&rng) & ((1L << b) - 1));
+            block = next[block];
+        }
+
+        free(next);
+    }
+}
+
+/**
+ * @brief Times one pattern on a fresh cache: read_byte, with every
+ *        BENCH_WRITE_EVERY-th access a write_byte.
+ * @param cache A cold cache, write-back and write-allocate
+ * @param mem Simulated main memory
+ * @param addrs Address sequence of BENCH_ACCESSES entries
+ * @return Nanoseconds per access
+ */
+double time_pattern(cache_t cache, uchar* mem, long* addrs) {
+
+    long checksum = 0;
+    double begin = now_ns();
+
+    for (int i = 0; i < BENCH_ACCESSES; i++) {
+        if (i % BENCH_WRITE_EVERY == BENCH_WRITE_EVERY - 1) {
+            write_byte(cache, mem, addrs[i], (uchar)i);
+        } else {
+            checksum += read_byte(cache, mem, addrs[i]);
+        }
+    }
+
+    bench_sink += checksum;
+    return (now_ns() - begin) / BENCH_ACCESSES;
+}
+
+/**
+ * @brief Access pattern benchmark: ns per access and accesses/sec of the
+ *        simulator for synthetic patterns across geometries.
+ *
+ * The working set is BENCH_WORKING_SET times the cache, patterns and seeds are
+ * fixed, and every run starts from a cold LRU cache, so the miss rate column
+ * is identical from run to run and only the timings vary.
+ */
+void bench_patterns() {
+
+    struct { uchar s, b, E; } geometries[] = {
+        {6, 5, 2},   // 4KB, 2-way, 32-byte blocks
+        {6, 6, 8},   // 32KB, 8-way (typical L1)
+        {10, 6, 16}, // 1MB, 16-way (typical L2)
+    };
+    const char* patterns[] = {"sequential", "strided", "random", "zipfian", "chase"};
+    int n_geometries = sizeof(geometries) / sizeof(geometries[0]);
+    int n_patterns = sizeof(patterns) / sizeof(patterns[0]);
+
+    long* addrs = malloc(sizeof(long) * BENCH_ACCESSES);
+
+    printf("\n%-22s %-10s %9s %14s %9s\n", "geometry", "pattern", "ns/access", "accesses/sec",
+        "miss rate");
+
+    for (int g = 0; g < n_geometries; g++) {
+        uchar s = geometries[g].s, b = geometries[g].b, E = geometries[g].E;
+        long cache_size = (long)E << (s + b);
+        long working_set = BENCH_WORKING_SET * cache_size;
+
+        // Tag bits cover the working set, which is a power of two times the cache
+        uchar t = 0;
+        while ((1L << (s + t + b)) < working_set) t++;
+
+        uchar* mem = malloc(working_set);
+        for (long i = 0; i < working_set; i++) {
+            mem[i] = (uchar)i;
+        }
+
+        char name[64];
+        snprintf(name, sizeof(name), "s=%d E=%d b=%d (%ldKB)", s, E, b, cache_size >> 10);
+
+        for (int p = 0; p < n_patterns; p++) {
+            generate_pattern(patterns[p], addrs, working_set, b);
+
+            double best = 1e9, miss_rate = 0;
+            for (int run = 0; run < BENCH_RUNS; run++) {
+                cache_t cache = initialize_cache_policy(s, t, b, E, &lru_policy);
+                cache.write_policy = WRITE_BACK | WRITE_ALLOCATE;
+
+                double ns = time_pattern(cache, mem, addrs);
+                if (ns < best) best = ns;
+                miss_rate = (double)total_misses(cache.stats) / total_accesses(cache.stats);
+            }
+
+            printf("%-22s %-10s %7.2fns %14.0f %9.4f\n", name, patterns[p], best, 1e9 / best,
+                miss_rate);
+        }
+
+        free(mem);
+    }
+
+    free(addrs);
+}
+
+/**
+ * @brief Benchmark driver for the cache simulator.
+ *
+ * With no arguments every benchmark runs; otherwise only the named ones
+ * (tagmatch, geometry, patterns).
+ */
+int main(int argc, char** argv) {
+
+    if (argc < 2) {
+        bench_tagmatch();
+        bench_geometry();
+        bench_patterns();
+        return 0;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "tagmatch") == 0) {
+            bench_tagmatch();
+        } else if (strcmp(argv[i], "geometry") == 0) {
+            bench_geometry();
+        } else if (strcmp(argv[i], "patterns") == 0) {
+            bench_patterns();
+        } else {
+            fprintf(stderr, "Usage: %s [tagmatch] [geometry] [patterns]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    return 0;
+}
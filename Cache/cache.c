@@ -1,59 +1,138 @@
 #include "cache.h"
+#include "policy.h"
+#include "stats.h"
+#include "prefetch.h"
+#include "specialize.h"
+#include "victim.h"
+#include "tlb.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-#define COLD_MISS 1
-#define CONFLICT_MISS 2
-#define CACHE_HIT 3
+/**
+ * @brief Initializes a cache that evicts the least frequently used line.
+ *
+ * Same as initialize_cache_policy with the original frequency policy.
+ *
+ * @param s Number of set index bits (S = 2^s sets)
+ * @param t Number of tag bits
+ * @param b Number of block offset bits (B = 2^b bytes per block)
+ * @param E Number of lines per set (associativity)
+ * @return Initialized cache_t structure (by value)
+ */
+cache_t initialize_cache(uchar s, uchar t, uchar b, uchar E) {
+    return initialize_cache_policy(s, t, b, E, &frequency_policy);
+}
 
 /**
  * @brief Initializes a cache structure with S sets, E lines per set, and B-byte blocks.
  *
- * Allocates memory for the cache structure, the sets, each line, and the blocks.
+ * Same as initialize_cache_storage with block storage.
+ *
+ * @param s Number of set index bits (S = 2^s sets)
+ * @param t Number of tag bits
+ * @param b Number of block offset bits (B = 2^b bytes per block)
+ * @param E Number of lines per set (associativity)
+ * @param policy Replacement policy used on conflict misses (see policy.h)
+ * @return Initialized cache_t structure (by value)
+ */
+cache_t initialize_cache_policy(uchar s, uchar t, uchar b, uchar E, const repl_policy_t* policy) {
+    return initialize_cache_storage(s, t, b, E, policy, 0);
+}
+
+/**
+ * @brief Initializes a cache structure, optionally without block storage.
+ *
+ * Allocates memory for the sets and each line. All blocks share one
+ * BLOCK_ALIGN-aligned slab, so a block never straddles more host cache lines
+ * than it must. A metadata-only cache allocates no blocks: it keeps tags,
+ * replacement state and statistics, while reads and writes go to main memory.
  * Initializes each line's `valid` and `frequency` fields to 0, and `tag` to 0.
  *
  * @param s Number of set index bits (S = 2^s sets)
  * @param t Number of tag bits
  * @param b Number of block offset bits (B = 2^b bytes per block)
  * @param E Number of lines per set (associativity)
+ * @param policy Replacement policy used on conflict misses (see policy.h)
+ * @param metadata_only Skip block storage and data copies
  * @return Initialized cache_t structure (by value)
  */
-cache_t initialize_cache(uchar s, uchar t, uchar b, uchar E) {
+cache_t initialize_cache_storage(uchar s, uchar t, uchar b, uchar E, const repl_policy_t* policy, int metadata_only) {
     int S = 1 << s;  // Number of sets
     int B = 1 << b;  // Block size in bytes
 
-    // Allocate memory for cache structure
-    cache_t * cache_array = (cache_t*)malloc(sizeof(cache_line_t));
+    // The cache structure itself is returned by value, only its sets live on the heap
+    cache_t cache_array;
 
     // Set cache parameters
-    cache_array->b = b;
-    cache_array->s = s;
-    cache_array->E = E;
-    cache_array->t = t;
+    cache_array.b = b;
+    cache_array.s = s;
+    cache_array.E = E;
+    cache_array.t = t;
+
+    // Precompute the address decomposition constants
+    cache_array.tag_shift = b + s;
+    cache_array.offset_mask = (1L << b) - 1;
+    cache_array.set_mask = (1L << s) - 1;
+
+    // Write-through, no-write-allocate unless the caller sets write_policy
+    cache_array.write_policy = 0;
+    cache_array.metadata_only = metadata_only;
+
+    // Replacement policy and its state
+    cache_array.policy = policy;
+    cache_array.repl = create_repl_state(s, E);
+
+    // Hit/miss counters, overall and per set
+    cache_array.stats = create_stats(s);
+
+    // No prefetcher, victim buffer or TLB unless one is attached
+    cache_array.prefetch = NULL;
+    cache_array.victim = NULL;
+    cache_array.tlb = NULL;
+    cache_array.spill = NULL;
+
+    // Unrolled probe and fill when the geometry has an instance
+    specialize_cache(&cache_array);
 
     // Allocate memory for sets (array of pointers to lines)
-    cache_array->cache = (cache_line_t**)malloc(sizeof(cache_line_t*) * S);
+    cache_array.cache = (cache_line_t**)malloc(sizeof(cache_line_t*) * S);
+
+    // One aligned slab for every block, rounded up as aligned_alloc requires
+    uchar* blocks = NULL;
+    if (!metadata_only) {
+        size_t slab = ((size_t)S * E * B + BLOCK_ALIGN - 1) & ~(size_t)(BLOCK_ALIGN - 1);
+        blocks = aligned_alloc(BLOCK_ALIGN, slab);
+        if (blocks == NULL) {
+            perror("cache allocation failed");
+            exit(1);
+        }
+    }
 
     // Initialize each set
     for (int i = 0; i < S; i++) {
 
         // Allocate memory for E lines in the set
-        cache_array->cache[i] = (cache_line_t*)malloc(sizeof(cache_line_t) * E);
+        cache_array.cache[i] = (cache_line_t*)malloc(sizeof(cache_line_t) * E);
 
         // Initialize each line in the set
         for (int j = 0; j < E; j++) {
-            // Allocate memory for the block
-            cache_array->cache[i][j].block = (uchar*)malloc(B);
+            // Point the line at its block in the slab
+            cache_array.cache[i][j].block = blocks ? blocks + ((size_t)i * E + j) * B : NULL;
             
             // Initialize metadata
-            cache_array->cache[i][j].frequency = 0;
-            cache_array->cache[i][j].valid = 0;
-            cache_array->cache[i][j].tag = 0;
+            cache_array.cache[i][j].frequency = 0;
+            cache_array.cache[i][j].valid = 0;
+            cache_array.cache[i][j].dirty = 0;
+            cache_array.cache[i][j].state = 0;
+            cache_array.cache[i][j].prefetched = 0;
+            cache_array.cache[i][j].tag = 0;
+            cache_array.cache[i][j].age = 0;
         }
     }
 
     // Return the initialized cache structure by value
-    return (*cache_array);
+    return cache_array;
 }
 
 /**
@@ -79,7 +158,7 @@ void print_cache(cache_t cache) {
                 cache.cache[i][j].frequency, cache.t, cache.cache[i][j].tag);
 
             // Print each byte in the block in hexadecimal
-            for (int k = 0; k < B; k++) {
+            for (int k = 0; k < B && !cache.metadata_only; k++) {
                 printf("%02x ", cache.cache[i][j].block[k]);
             }
             puts(""); // Newline after each line
@@ -91,8 +170,8 @@ void print_cache(cache_t cache) {
  * @brief Reads a byte from the cache, handling hits and misses.
  *
  * Extracts set index, tag, and block offset from the address, checks
- * the cache for a hit or miss, updates frequency or inserts data as needed,
- * and finally returns the requested byte.
+ * the cache for a hit or miss, updates the replacement policy or inserts
+ * data as needed, and finally returns the requested byte.
  *
  * @param cache The cache structure (by value)
  * @param start Pointer to the start of main memory (from which data is fetched on miss)
@@ -101,40 +180,323 @@ void print_cache(cache_t cache) {
  */
 uchar read_byte(cache_t cache, uchar* start, long int off) {
 
-    // Extract set index, tag, and block offset from the memory address
-    address_t* addr_type = extract_bts_from_address(off, cache.s, cache.t, cache.b);
+    int status;
+    long evicted;
+
+    if (cache.tlb) {
+        off = translate_address(cache, off);
+    }
+
+    if (cache.prefetch) {
+        prefetch_before(cache, start, off);
+    }
+
+    // Look the block up, filling it on a miss
+    cache_line_t* line = fetch_line(cache, start, off, &status, &evicted);
+
+    if (cache.prefetch) {
+        prefetch_after(cache, start, off, line, status);
+    }
+
+    // Return the byte from the line/block at the offset
+    if (cache.metadata_only) {
+        return start[off];
+    }
+    return line->block[off & cache.offset_mask];
+}
+
+/**
+ * @brief Looks up the block holding an address, filling it on a miss.
+ *
+ * Counts the access in the cache statistics and updates the replacement
+ * policy. This is read_byte without the final byte read, for callers (like
+ * the cache hierarchy) that need to know what happened.
+ *
+ * @param cache The cache structure (by value)
+ * @param start Pointer to the start of main memory
+ * @param off The memory address offset to read
+ * @param status Set to CACHE_HIT, COLD_MISS, or CONFLICT_MISS
+ * @param evicted Set to the address of the block replaced on a conflict miss, -1 otherwise
+ * @return Pointer to the line now holding the block
+ */
+cache_line_t* fetch_line(cache_t cache, uchar* start, long int off, int* status, long* evicted) {
+    return access_line(cache, start, off, 0, status, evicted);
+}
+
+/**
+ * @brief fetch_line that counts the access as a read or a write.
+ * @param cache The cache structure (by value)
+ * @param start Pointer to the start of main memory
+ * @param off The memory address offset
+ * @param is_write Non-zero to count a write access
+ * @param status Set to CACHE_HIT, COLD_MISS, or CONFLICT_MISS
+ * @param evicted Set to the address of the block replaced on a conflict miss, -1 otherwise
+ * @return Pointer to the line now holding the block
+ */
+cache_line_t* access_line(cache_t cache, uchar* start, long int off, int is_write, int* status, long* evicted) {
+
+    // Extract set index and tag from the memory address
+    address_t addr_type = decode_address(cache, off);
 
     // Get pointer to the set corresponding to the address
-    cache_line_t* set = cache.cache[addr_type->set_index];
+    cache_line_t* set = cache.cache[addr_type.set_index];
     
     int line_index = 0;
 
     // Check cache status: hit, cold miss, or conflict miss
-    int status = get_status(set, cache.E, addr_type->tag, &line_index);
+    *status = cache.lookup(set, cache.E, addr_type.tag, &line_index);
+    record_access(cache.stats, addr_type.set_index, is_write, *status);
 
-    // Get pointer to the specific cache line
-    cache_line_t *line = set + line_index;
+    *evicted = -1;
 
     // Handle cache hit/miss accordingly
-    switch (status)
+    switch (*status)
     {
-        case COLD_MISS:
         case CONFLICT_MISS:
+        case COLD_MISS:
             // Insert data from memory to cache block on miss
-            insert_data_to_block(line, start, off, cache.b, addr_type->tag);
+            line_index = install_block(cache, start, off, evicted);
             break; 
     
         case CACHE_HIT:
-            // Increment frequency counter on hit
-            line->frequency += 1;
+            // Update the replacement policy on hit
+            cache.policy->on_hit(&cache, addr_type.set_index, line_index);
             break;
 
         default:
             break;
     }
 
-    // Return the byte from the line/block at the offset
-    return line->block[addr_type->offset];
+    return set + line_index;
+}
+
+/**
+ * @brief Places the block holding an address into its set.
+ *
+ * Uses an empty line if there is one, otherwise evicts the line chosen by
+ * the replacement policy. Evictions are counted, but the access itself is
+ * not (see fetch_line). If the block is already cached nothing changes.
+ *
+ * @param cache The cache structure (by value)
+ * @param start Pointer to the start of main memory
+ * @param off Any memory address offset inside the block
+ * @param evicted Set to the address of the block replaced, -1 if none
+ * @return Index of the line holding the block
+ */
+int install_block(cache_t cache, uchar* start, long int off, long* evicted) {
+    return place_block(cache, start, off, NULL, 0, evicted);
+}
+
+/**
+ * @brief Hands a line over before it is reused or invalidated.
+ *
+ * A hierarchy level copies the line into its spill line, and the hierarchy
+ * passes it on to the next level. Any other cache writes it back to memory
+ * if it is dirty.
+ */
+static void release_line(cache_t cache, uchar* start, long set_index, cache_line_t* line) {
+
+    if (cache.spill == NULL) {
+        write_back_line(cache, start, set_index, line);
+        return;
+    }
+
+    cache.spill->valid = line->valid;
+    cache.spill->dirty = line->dirty;
+    cache.spill->tag = line->tag;
+    if (!cache.metadata_only) {
+        memcpy(cache.spill->block, line->block, (size_t)1 << cache.b);
+    }
+    line->dirty = 0;
+}
+
+/**
+ * @brief install_block with the contents supplied by the caller.
+ *
+ * With data set, the block comes from another cache level or a stream
+ * buffer: it is copied from data, keeps the given dirty bit, is not counted
+ * as a block fill and skips the victim cache.
+ * A block that is already cached takes the new contents. With data NULL
+ * this is install_block.
+ *
+ * @param cache The cache structure (by value)
+ * @param start Pointer to the start of main memory
+ * @param off Any memory address offset inside the block
+ * @param data Block contents, NULL to fetch them from memory
+ * @param dirty Dirty bit of the placed line (with data only)
+ * @param evicted Set to the address of the block replaced, -1 if none
+ * @return Index of the line holding the block
+ */
+int place_block(cache_t cache, uchar* start, long int off, const uchar* data, int dirty, long* evicted) {
+
+    address_t addr_type = decode_address(cache, off);
+    cache_line_t* set = cache.cache[addr_type.set_index];
+    size_t B = (size_t)1 << cache.b;
+    int line_index = 0;
+
+    *evicted = -1;
+
+    int status = cache.lookup(set, cache.E, addr_type.tag, &line_index);
+    if (status == CACHE_HIT) {
+        if (data != NULL) {
+            if (!cache.metadata_only) {
+                memcpy(set[line_index].block, data, B);
+            }
+            set[line_index].dirty |= dirty;
+        }
+        return line_index;
+    }
+
+    // A victim or miss cache may hold the block, saving the memory fetch
+    int buffered = data == NULL && cache.victim
+        && victim_probe(cache.victim, off & ~cache.offset_mask);
+
+    switch (status)
+    {
+        case CONFLICT_MISS:
+            // Let the replacement policy choose the line to evict
+            line_index = cache.policy->victim(&cache, addr_type.set_index);
+            *evicted = block_address(cache, addr_type.set_index, set[line_index].tag);
+            record_eviction(cache.stats, addr_type.set_index);
+
+            // A dirty victim must be saved before its line is reused
+            release_line(cache, start, addr_type.set_index, set + line_index);
+
+            if (cache.victim && cache.victim->mode == VICTIM_CACHE) {
+                victim_insert(cache.victim, *evicted);
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    if (data != NULL) {
+        cache.fill(set + line_index, NULL, off, cache.b, addr_type.tag);
+        if (!cache.metadata_only) {
+            memcpy(set[line_index].block, data, B);
+        }
+        set[line_index].dirty = dirty;
+    } else {
+        cache.fill(set + line_index, cache.metadata_only ? NULL : start, off, cache.b,
+            addr_type.tag);
+    }
+    cache.policy->on_fill(&cache, addr_type.set_index, line_index);
+
+    if (data == NULL && !buffered) {
+        cache.stats->block_fills++;
+        if (cache.victim && cache.victim->mode == MISS_CACHE) {
+            victim_insert(cache.victim, off & ~cache.offset_mask);
+        }
+    }
+
+    return line_index;
+}
+
+/**
+ * @brief Copies a dirty line back to main memory and marks it clean.
+ * @param cache The cache structure
+ * @param start Pointer to the start of main memory
+ * @param set_index Set holding the line
+ * @param line The line to write back (nothing happens if it is clean)
+ */
+void write_back_line(cache_t cache, uchar* start, long set_index, cache_line_t* line) {
+
+    if (!line->valid || !line->dirty) {
+        return;
+    }
+
+    if (!cache.metadata_only) {
+        memcpy(start + block_address(cache, set_index, line->tag), line->block, (size_t)1 << cache.b);
+    }
+
+    line->dirty = 0;
+    cache.stats->write_backs++;
+}
+
+/**
+ * @brief Writes every dirty line back to main memory.
+ * @param cache The cache structure
+ * @param start Pointer to the start of main memory
+ */
+void flush_cache(cache_t cache, uchar* start) {
+    long S = 1L << cache.s;
+    for (long i = 0; i < S; i++) {
+        for (int j = 0; j < cache.E; j++) {
+            write_back_line(cache, start, i, &cache.cache[i][j]);
+        }
+    }
+}
+
+/**
+ * @brief Checks whether the block holding an address is cached, without
+ *        touching statistics or replacement state.
+ * @param cache The cache structure
+ * @param off Memory address offset
+ * @return CACHE_HIT, COLD_MISS, or CONFLICT_MISS
+ */
+int probe_block(cache_t cache, long int off) {
+    address_t addr_type = decode_address(cache, off);
+    int line_index;
+    return cache.lookup(cache.cache[addr_type.set_index], cache.E, addr_type.tag, &line_index);
+}
+
+/**
+ * @brief Returns the line holding the block of an address, without touching
+ *        statistics or replacement state.
+ * @param cache The cache structure
+ * @param off Memory address offset
+ * @return Pointer to the line, or NULL if the block is not cached
+ */
+cache_line_t* find_line(cache_t cache, long int off) {
+
+    address_t addr_type = decode_address(cache, off);
+    cache_line_t* set = cache.cache[addr_type.set_index];
+    int line_index;
+
+    if (cache.lookup(set, cache.E, addr_type.tag, &line_index) != CACHE_HIT) {
+        return NULL;
+    }
+    return set + line_index;
+}
+
+/**
+ * @brief Drops the block holding an address from the cache, if present.
+ *
+ * A dirty line is written back to memory first, so no data is lost. A
+ * hierarchy level copies the line into its spill line instead.
+ *
+ * @param cache The cache structure
+ * @param start Pointer to the start of main memory
+ * @param off Memory address offset
+ * @return 1 if a line was invalidated, 0 otherwise
+ */
+int invalidate_block(cache_t cache, uchar* start, long int off) {
+
+    address_t addr_type = decode_address(cache, off);
+    cache_line_t* set = cache.cache[addr_type.set_index];
+    int line_index;
+
+    if (cache.lookup(set, cache.E, addr_type.tag, &line_index) != CACHE_HIT) {
+        return 0;
+    }
+
+    release_line(cache, start, addr_type.set_index, set + line_index);
+
+    set[line_index].valid = 0;
+    set[line_index].frequency = 0;
+    return 1;
+}
+
+/**
+ * @brief Rebuilds the first address of a block from its set index and tag.
+ * @param cache The cache structure
+ * @param set_index Set holding the block
+ * @param tag Tag of the block
+ * @return Address of the first byte of the block
+ */
+long block_address(cache_t cache, long set_index, long tag) {
+    return (tag << cache.tag_shift) | (set_index << cache.b);
 }
 
 /**
@@ -142,31 +504,32 @@ uchar read_byte(cache_t cache, uchar* start, long int off) {
  *
  * Aligns the memory address to the start of the block, sets the cache
  * line metadata (valid, frequency, tag), and copies B bytes from memory
- * into the cache line's block.
+ * into the cache line's block in one memcpy.
  *
  * @param line Pointer to the cache line to fill
- * @param start Pointer to the start of main memory
+ * @param start Pointer to the start of main memory, NULL to set the metadata only
  * @param off Memory address offset to start copying from
  * @param b Number of block offset bits (B = 2^b bytes per block)
  * @param tag Tag value to assign to the cache line
  */
 void insert_data_to_block(cache_line_t *line, uchar* start, long int off, uchar b, long tag) {
 
-    int B = 1 << b;  // Calculate block size in bytes
+    size_t B = (size_t)1 << b;  // Calculate block size in bytes
 
     // Align the offset to the start of the block
-    while (off % B != 0) {
-        off -= 1;
-    }
-    
+    off &= ~(long)(B - 1);
+
     // Set cache line metadata
     line->valid = 1;
+    line->dirty = 0;
+    line->state = 0;
+    line->prefetched = 0;
     line->frequency = 1;
     line->tag = tag;
     
     // Copy B bytes from memory into the cache line's block
-    for (int i = 0; i < B; i++) {
-        line->block[i] = *(start + off + i);
+    if (start != NULL) {
+        memcpy(line->block, start + off, B);
     }
 }
 
@@ -175,26 +538,32 @@ void insert_data_to_block(cache_line_t *line, uchar* start, long int off, uchar
  *
  * Checks each line in the set for a cache hit, cold miss, or conflict miss.
  * Updates the line index to indicate which line should be used/evicted.
+ * Lines can be invalidated (e.g. by a cache hierarchy), so the whole set is
+ * searched for the tag before an empty line is reported as a cold miss.
  *
  * @param set Pointer to the cache set (array of lines)
  * @param num_of_lines Number of lines in the set (E)
  * @param tag The tag to search for in the set
  * @param line_index Pointer to store the index of the line to use/evict
+ *        (on a conflict miss, the least frequently used line; read_byte
+ *        asks the cache's replacement policy instead)
  * @return Status of the cache access: CACHE_HIT, COLD_MISS, or CONFLICT_MISS
  */
 int get_status(cache_line_t *set, uchar num_of_lines, long tag, int *line_index) {
 
     // Initialize: assume first line as victim for possible eviction
-    int min_frequency = set[0].frequency;
-    *line_index = 0;
+    int victim = 0;
+    int empty = -1;
 
     // Loop through all lines in the set
     for (int i = 0; i < num_of_lines; i++) {
 
-        // If an empty line found (never used)
+        // Remember the first empty line (never used, or invalidated)
         if (!set[i].valid) {
-            *line_index = i; // Line available for insertion
-            return COLD_MISS; // Cold miss (first-time use)
+            if (empty < 0) {
+                empty = i;
+            }
+            continue;
         }
 
         // If tag matches, it is a cache hit
@@ -204,15 +573,22 @@ int get_status(cache_line_t *set, uchar num_of_lines, long tag, int *line_index)
         }
 
         // Update victim line if current line has lower frequency
-        if (set[i].frequency < min_frequency) {
-            min_frequency = set[i].frequency;
-            *line_index = i; // Candidate for eviction (conflict miss)
+        if (set[i].frequency < set[victim].frequency) {
+            victim = i; // Candidate for eviction (conflict miss)
         }
     }
 
+    // No hit: fill an empty line if there is one (cold miss)
+    if (empty >= 0) {
+        *line_index = empty;
+        return COLD_MISS;
+    }
+
     // No hit and no empty line found: conflict miss
+    *line_index = victim;
     return CONFLICT_MISS;
 }
+
 /**
  * @brief Extracts offset, set index, and tag bits from a memory address.
  *
@@ -222,46 +598,49 @@ int get_status(cache_line_t *set, uchar num_of_lines, long tag, int *line_index)
  * @param s Number of set index bits
  * @param t Number of tag bits
  * @param b Number of block offset bits
- * @return Pointer to a dynamically allocated address_t structure
+ * @return The address components (by value)
  */
-address_t* extract_bts_from_address(long int dec_addr, uchar s, uchar t, uchar b) {
+address_t extract_bts_from_address(long int dec_addr, uchar s, uchar t, uchar b) {
 
-    address_t* address_ptr = (address_t*)malloc(sizeof(address_t));
+    address_t address;
 
-    // Extract block offset bits (least significant b bits)
-    for (int i = 0; i < b; i++) {
-        if (dec_addr % 2) {
-            address_ptr->offset += (1 << i);
-        }
-        dec_addr /= 2;
-    }
+    // Block offset is the least significant b bits, set index the next s bits,
+    // and the remaining bits are tag bits
+    address.offset = dec_addr & ((1L << b) - 1);
+    address.set_index = (dec_addr >> b) & ((1L << s) - 1);
+    address.tag = dec_addr >> (b + s);
 
-    // Extract set index bits (next s bits)
-    for (int i = 0; i < s; i++) {
-        if (dec_addr % 2) {
-            address_ptr->set_index += (1 << i);
-        }
-        dec_addr /= 2;
-    }
+    return address;
+}
 
-    // Remaining bits are tag bits
-    int i = 0;
-    while (dec_addr) {
-        if (dec_addr % 2) {
-            address_ptr->tag += (1 << i);
-        }
-        i++;
-        dec_addr /= 2;
-    }
+/**
+ * @brief Splits a memory address using the masks precomputed in the cache.
+ *
+ * Same result as extract_bts_from_address, but without recomputing the
+ * masks, so the per-access path is a handful of shifts and ands.
+ *
+ * @param cache The cache structure
+ * @param addr Memory address
+ * @return The address components (by value)
+ */
+address_t decode_address(cache_t cache, long int addr) {
+
+    address_t address;
+
+    address.offset = addr & cache.offset_mask;
+    address.set_index = (addr >> cache.b) & cache.set_mask;
+    address.tag = addr >> cache.tag_shift;
 
-    return address_ptr;
+    return address;
 }
 
 /**
- * @brief Writes a byte to memory and updates the cache if there is a cache hit.
+ * @brief Writes a byte through the cache according to its write policy.
  *
- * Checks the cache for the target address, updates the cache line on hit, 
- * and always writes to main memory.
+ * Without WRITE_ALLOCATE a miss writes straight to main memory; with it the
+ * block is first fetched into the cache. With WRITE_BACK a cached write only
+ * updates the line and marks it dirty, and memory is updated when the line
+ * is evicted; otherwise every write also goes to main memory.
  *
  * @param cache The cache structure
  * @param start Pointer to main memory
@@ -269,62 +648,55 @@ address_t* extract_bts_from_address(long int dec_addr, uchar s, uchar t, uchar b
  * @param new New byte value to write
  */
 void write_byte(cache_t cache, uchar* start, long int off, uchar new) {
-    
-    address_t* addr_type = extract_bts_from_address(off, cache.s, cache.t, cache.b);
-    cache_line_t* set = cache.cache[addr_type->set_index];
-    
-    int line_index = 0;
-    int status = get_status(set, cache.E, addr_type->tag, &line_index);
-    cache_line_t *line = set + line_index; // pointer to the cache line
 
-    // Update cache line only on hit
-    if (status == CACHE_HIT) {
-        line->frequency += 1;
-        line->block[addr_type->offset] = new;
+    if (cache.tlb) {
+        off = translate_address(cache, off);
     }
-    
-    // Always write to main memory
-    *(start + off) = new;
-}
 
-/**
- * @brief Main function: reads memory, initializes cache, and simulates cache accesses.
- *
- * Prompts for memory size and data, cache parameters, and a series of memory reads.
- * Prints cache content at the end.
- */
-int main() {
+    address_t addr_type = decode_address(cache, off);
+    cache_line_t* set = cache.cache[addr_type.set_index];
 
-    int n;
-    printf("Size of data: ");
-    scanf("%d", &n);
-
-    // Allocate memory
-    uchar* mem = malloc(n);
-    printf("Input data >> ");
+    if (cache.prefetch) {
+        prefetch_before(cache, start, off);
+    }
 
-    for (int i = 0; i < n; i++)
-        scanf("%hhd", mem + i);
+    int line_index = 0;
+    int status = cache.lookup(set, cache.E, addr_type.tag, &line_index);
+    record_access(cache.stats, addr_type.set_index, 1, status);
 
-    // Read cache parameters
-    int s, t, b, E;
-    printf("s t b E: ");
-    scanf("%d %d %d %d", &s, &t, &b, &E);
+    if (status == CACHE_HIT) {
+        cache.policy->on_hit(&cache, addr_type.set_index, line_index);
+    } else if (cache.write_policy & WRITE_ALLOCATE) {
+        long evicted;
+        line_index = install_block(cache, start, off, &evicted);
+    } else {
+        // No-write-allocate miss: write around the cache
+        start[off] = new;
+        cache.stats->write_throughs++;
+
+        if (cache.prefetch) {
+            prefetch_after(cache, start, off, NULL, status);
+        }
+        return;
+    }
 
-    // Initialize cache
-    cache_t cache = initialize_cache(s, t, b, E);
+    cache_line_t *line = set + line_index; // pointer to the cache line
 
-    // Simulate cache reads until negative number is entered
-    while (1) {
-        scanf("%d", &n);
-        if (n < 0) break;
-        read_byte(cache, mem, n);
+    // A metadata-only cache keeps the data in memory; the line just tracks it
+    if (cache.metadata_only) {
+        start[off] = new;
+    } else {
+        line->block[addr_type.offset] = new;
     }
 
-    // Print cache contents
-    puts("");
-    print_cache(cache);
+    if (cache.write_policy & WRITE_BACK) {
+        line->dirty = 1;
+    } else {
+        start[off] = new;
+        cache.stats->write_throughs++;
+    }
 
-    // Free allocated memory
-    free(mem);
+    if (cache.prefetch) {
+        prefetch_after(cache, start, off, line, status);
+    }
 }
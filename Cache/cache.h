@@ -1,18 +1,62 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#define COLD_MISS 1
+#define CONFLICT_MISS 2
+#define CACHE_HIT 3
+
+#define WRITE_BACK 1     // write_policy flag: defer memory writes until eviction
+#define WRITE_ALLOCATE 2 // write_policy flag: fetch the block on a write miss
+
+#define BLOCK_ALIGN 64 // Alignment of the block storage (host cache line)
+
 typedef unsigned char uchar;
 
-typedef struct cache_line_s {
+typedef struct repl_policy_s repl_policy_t; // Replacement policy (policy.h)
+typedef struct repl_state_s repl_state_t;   // Replacement policy state (policy.h)
+typedef struct cache_stats_s cache_stats_t; // Hit/miss counters (stats.h)
+typedef struct prefetcher_s prefetcher_t;       // Prefetcher (prefetch.h)
+typedef struct prefetch_state_s prefetch_state_t; // Prefetcher state (prefetch.h)
+typedef struct victim_cache_s victim_cache_t;   // Victim / miss cache (victim.h)
+typedef struct tlb_s tlb_t;                     // Address translation (tlb.h)
+
+typedef struct cache_line_s cache_line_t;
+
+// Set probe and block fill, specialized per geometry (specialize.h)
+typedef int (*lookup_fn_t)(cache_line_t* set, uchar num_of_lines, long tag, int* line_index);
+typedef void (*fill_fn_t)(cache_line_t* line, uchar* start, long int off, uchar b, long tag);
+
+struct cache_line_s {
     uchar valid;
+    uchar dirty;       // Modified since filled (write-back caches only)
+    uchar state;       // Coherence state (coherence.h), 0 outside coherence simulation
     uchar frequency;
+    uchar prefetched;  // Filled by the prefetcher and not used by a demand access yet
     long int tag;
     uchar* block;
-} cache_line_t;
+    unsigned long age; // Policy state: LRU/FIFO stamp or RRIP prediction
+};
 
 typedef struct cache_s {
     uchar s;
     uchar t;
     uchar b;
     uchar E;
+    uchar write_policy; // WRITE_BACK and/or WRITE_ALLOCATE, 0 = write-through, no-allocate
+    uchar metadata_only; // Tags and state only: no block storage, data stays in main memory
+    uchar tag_shift;   // b + s: position of the lowest tag bit
+    long offset_mask;  // 2^b - 1
+    long set_mask;     // 2^s - 1
     cache_line_t** cache;
+    const repl_policy_t* policy;
+    repl_state_t* repl;
+    cache_stats_t* stats;
+    prefetch_state_t* prefetch; // Hardware prefetcher, NULL = none
+    victim_cache_t* victim;     // Victim or miss cache, NULL = none
+    tlb_t* tlb;                 // Translates addresses before every access, NULL = none
+    cache_line_t* spill;        // Hierarchy level: receives victims for the next level, NULL = write back
+    lookup_fn_t lookup;         // get_status, or its instance for this E
+    fill_fn_t fill;             // insert_data_to_block, or its instance for this b
 } cache_t;
 
 typedef struct address_s
@@ -23,8 +67,24 @@ typedef struct address_s
 } address_t;
 
 cache_t initialize_cache(uchar s, uchar t, uchar b, uchar E);
+cache_t initialize_cache_policy(uchar s, uchar t, uchar b, uchar E, const repl_policy_t* policy);
+cache_t initialize_cache_storage(uchar s, uchar t, uchar b, uchar E, const repl_policy_t* policy, int metadata_only);
+void print_cache(cache_t cache);
 uchar read_byte(cache_t cache, uchar* start, long int off);
+cache_line_t* fetch_line(cache_t cache, uchar* start, long int off, int* status, long* evicted);
+cache_line_t* access_line(cache_t cache, uchar* start, long int off, int is_write, int* status, long* evicted);
+int install_block(cache_t cache, uchar* start, long int off, long* evicted);
+int place_block(cache_t cache, uchar* start, long int off, const uchar* data, int dirty, long* evicted);
+int probe_block(cache_t cache, long int off);
+cache_line_t* find_line(cache_t cache, long int off);
+int invalidate_block(cache_t cache, uchar* start, long int off);
+void write_back_line(cache_t cache, uchar* start, long set_index, cache_line_t* line);
+void flush_cache(cache_t cache, uchar* start);
+long block_address(cache_t cache, long set_index, long tag);
 void write_byte(cache_t cache, uchar* start, long int off, uchar new);
-address_t* extract_bts_from_address(long int addr, uchar s, uchar t, uchar b);
+address_t extract_bts_from_address(long int addr, uchar s, uchar t, uchar b);
+address_t decode_address(cache_t cache, long int addr);
 int get_status(cache_line_t *set, uchar num_of_lines, long tag, int *line_index);
 void insert_data_to_block(cache_line_t *line, uchar* start, long int off, uchar b, long tag);
+
+#endif
@@ -0,0 +1,239 @@
+#include "cache_soa.h"
+#include "tagmatch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Rounds n up to a multiple of HOST_LINE.
+ */
+static size_t round_to_line(size_t n) {
+    return (n + HOST_LINE - 1) & ~(size_t)(HOST_LINE - 1);
+}
+
+/**
+ * @brief Initializes a structure-of-arrays cache with S sets, E lines per set, and B-byte blocks.
+ *
+ * Makes a single aligned allocation holding every set's metadata record
+ * followed by the block data slab. All lines start invalid with frequency 0.
+ *
+ * @param s Number of set index bits (S = 2^s sets)
+ * @param t Number of tag bits
+ * @param b Number of block offset bits (B = 2^b bytes per block)
+ * @param E Number of lines per set (associativity)
+ * @return Initialized soa_cache_t structure (by value)
+ */
+soa_cache_t initialize_soa_cache(uchar s, uchar t, uchar b, uchar E) {
+
+    soa_cache_t cache;
+    long S = 1L << s; // Number of sets
+
+    // Set cache parameters and the address decomposition constants
+    cache.s = s;
+    cache.t = t;
+    cache.b = b;
+    cache.E = E;
+    cache.tag_shift = b + s;
+    cache.offset_mask = (1L << b) - 1;
+    cache.set_mask = S - 1;
+
+    // tags[E] + frequency[E] + valid[E], padded to whole host lines
+    cache.set_stride = round_to_line(E * (sizeof(long) + 2));
+
+    size_t meta_size = S * cache.set_stride;
+    size_t data_size = round_to_line((size_t)S * E << b);
+
+    // One allocation for metadata and data
+    cache.meta = aligned_alloc(HOST_LINE, meta_size + data_size);
+    if (cache.meta == NULL) {
+        perror("cache allocation failed");
+        exit(1);
+    }
+    cache.data = cache.meta + meta_size;
+
+    // Zero frequencies, valid bits and data, then mark every tag invalid
+    memset(cache.meta, 0, meta_size + data_size);
+    for (long i = 0; i < S; i++) {
+        long* tags = soa_tags(cache, i);
+        for (int j = 0; j < E; j++) {
+            tags[j] = INVALID_TAG;
+        }
+    }
+
+    return cache;
+}
+
+/**
+ * @brief Releases the single allocation backing a structure-of-arrays cache.
+ * @param cache The cache structure
+ */
+void free_soa_cache(soa_cache_t cache) {
+    free(cache.meta);
+}
+
+/**
+ * @brief Prints the entire cache contents in the same format as print_cache.
+ * @param cache The cache structure to print (by value)
+ */
+void print_soa_cache(soa_cache_t cache) {
+    long S = 1L << cache.s; // Number of sets
+    int B = 1 << cache.b;   // Block size in bytes
+
+    for (long i = 0; i < S; i++) {
+        printf("Set %ld\n", i);
+
+        long* tags = soa_tags(cache, i);
+        uchar* frequency = soa_frequency(cache, i);
+        uchar* valid = soa_valid(cache, i);
+
+        for (int j = 0; j < cache.E; j++) {
+            uchar* block = soa_block(cache, i, j);
+
+            // Empty lines print tag 0, like the pointer-based engine
+            printf("%1d %d 0x%0*lx ", valid[j], frequency[j], cache.t,
+                valid[j] ? tags[j] : 0);
+
+            for (int k = 0; k < B; k++) {
+                printf("%02x ", block[k]);
+            }
+            puts("");
+        }
+    }
+}
+
+/**
+ * @brief Scalar probe used for sets narrower than SIMD_MIN_WAYS.
+ */
+static int soa_get_status_scalar(soa_cache_t cache, long set_index, long tag, int *line_index) {
+
+    long* tags = soa_tags(cache, set_index);
+    int E = cache.E;
+
+    for (int i = 0; i < E; i++) {
+        if (tags[i] == tag) {
+            *line_index = i;
+            return CACHE_HIT;
+        }
+    }
+
+    if (tags[E - 1] == INVALID_TAG) {
+        *line_index = find_tag_scalar(tags, E, INVALID_TAG);
+        return COLD_MISS;
+    }
+
+    *line_index = find_min_frequency_scalar(soa_frequency(cache, set_index), E);
+    return CONFLICT_MISS;
+}
+
+/**
+ * @brief Determines the cache status for a given tag in a set.
+ *
+ * Same decision as get_status: a matching valid line is a hit, otherwise the
+ * first empty line is a cold miss, otherwise the first line with the lowest
+ * frequency is the conflict-miss victim. The tag scan reads only the packed
+ * tag array, since empty lines hold INVALID_TAG and never match. Sets of at
+ * least SIMD_MIN_WAYS lines are scanned with the vectorized kernels in tagmatch.c.
+ *
+ * @param cache The cache structure
+ * @param set_index Index of the set to probe
+ * @param tag The tag to search for in the set
+ * @param line_index Pointer to store the index of the line to use/evict
+ * @return Status of the cache access: CACHE_HIT, COLD_MISS, or CONFLICT_MISS
+ */
+int soa_get_status(soa_cache_t cache, long set_index, long tag, int *line_index) {
+
+    long* tags = soa_tags(cache, set_index);
+    int E = cache.E;
+
+    // Narrow sets are cheaper to scan inline than through a kernel pointer
+    if (E < SIMD_MIN_WAYS) {
+        return soa_get_status_scalar(cache, set_index, tag, line_index);
+    }
+
+    // Probe the tag array
+    int i = find_tag(tags, E, tag);
+    if (i >= 0) {
+        *line_index = i;
+        return CACHE_HIT;
+    }
+
+    // Lines are filled in order, so an empty line means a cold miss
+    if (tags[E - 1] == INVALID_TAG) {
+        *line_index = find_tag(tags, E, INVALID_TAG);
+        return COLD_MISS;
+    }
+
+    // Victim is the first line with the lowest frequency
+    *line_index = find_min_frequency(soa_frequency(cache, set_index), E);
+    return CONFLICT_MISS;
+}
+
+/**
+ * @brief Fills a line with the block containing off and sets its metadata.
+ * @param cache The cache structure
+ * @param set_index Index of the set holding the line
+ * @param line Index of the line in the set
+ * @param start Pointer to the start of main memory
+ * @param off Memory address offset inside the block
+ * @param tag Tag value to assign to the line
+ */
+static void soa_fill_line(soa_cache_t cache, long set_index, int line, uchar* start, long off, long tag) {
+
+    soa_tags(cache, set_index)[line] = tag;
+    soa_frequency(cache, set_index)[line] = 1;
+    soa_valid(cache, set_index)[line] = 1;
+
+    memcpy(soa_block(cache, set_index, line), start + (off & ~cache.offset_mask),
+        (size_t)1 << cache.b);
+}
+
+/**
+ * @brief Reads a byte through the structure-of-arrays cache.
+ *
+ * Behaves exactly like read_byte: misses fill the chosen line from memory,
+ * hits increment the line's frequency.
+ *
+ * @param cache The cache structure (by value)
+ * @param start Pointer to the start of main memory
+ * @param off The memory address offset to read
+ * @return The byte value read from the cache block
+ */
+uchar soa_read_byte(soa_cache_t cache, uchar* start, long int off) {
+
+    long set_index = (off >> cache.b) & cache.set_mask;
+    long tag = off >> cache.tag_shift;
+    int line_index = 0;
+
+    if (soa_get_status(cache, set_index, tag, &line_index) == CACHE_HIT) {
+        soa_frequency(cache, set_index)[line_index] += 1;
+    } else {
+        soa_fill_line(cache, set_index, line_index, start, off, tag);
+    }
+
+    return soa_block(cache, set_index, line_index)[off & cache.offset_mask];
+}
+
+/**
+ * @brief Writes a byte to memory and updates the cache if there is a cache hit.
+ *
+ * Write-through, no-write-allocate, like write_byte.
+ *
+ * @param cache The cache structure
+ * @param start Pointer to main memory
+ * @param off Memory address offset
+ * @param new New byte value to write
+ */
+void soa_write_byte(soa_cache_t cache, uchar* start, long int off, uchar new) {
+
+    long set_index = (off >> cache.b) & cache.set_mask;
+    long tag = off >> cache.tag_shift;
+    int line_index = 0;
+
+    if (soa_get_status(cache, set_index, tag, &line_index) == CACHE_HIT) {
+        soa_frequency(cache, set_index)[line_index] += 1;
+        soa_block(cache, set_index, line_index)[off & cache.offset_mask] = new;
+    }
+
+    // Always write to main memory
+    start[off] = new;
+}
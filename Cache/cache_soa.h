@@ -0,0 +1,60 @@
+#ifndef CACHE_SOA_H
+#define CACHE_SOA_H
+
+#include <stddef.h>
+#include "cache.h"
+
+#define HOST_LINE 64      // Host cache line size, alignment of every set and block
+#define INVALID_TAG (-1L) // Tag stored in invalid lines (real tags are never negative)
+
+/*
+ * Structure-of-arrays cache engine.
+ *
+ * All metadata and data live in one allocation. Each set owns a HOST_LINE
+ * aligned metadata record laid out as
+ *
+ *     long  tags[E];       (INVALID_TAG while the line is empty)
+ *     uchar frequency[E];
+ *     uchar valid[E];
+ *
+ * so probing a set for a tag reads E * 8 contiguous bytes (one host line for
+ * E <= 8). Blocks are packed set by set in a separate aligned data slab.
+ */
+typedef struct soa_cache_s {
+    uchar s;
+    uchar t;
+    uchar b;
+    uchar E;
+    uchar tag_shift;
+    long offset_mask;
+    long set_mask;
+    size_t set_stride; // Bytes of metadata per set (multiple of HOST_LINE)
+    uchar* meta;       // S metadata records
+    uchar* data;       // S * E * B bytes of block data
+} soa_cache_t;
+
+soa_cache_t initialize_soa_cache(uchar s, uchar t, uchar b, uchar E);
+void free_soa_cache(soa_cache_t cache);
+void print_soa_cache(soa_cache_t cache);
+uchar soa_read_byte(soa_cache_t cache, uchar* start, long int off);
+void soa_write_byte(soa_cache_t cache, uchar* start, long int off, uchar new);
+int soa_get_status(soa_cache_t cache, long set_index, long tag, int *line_index);
+
+/* Accessors into a set's metadata record */
+static inline long* soa_tags(soa_cache_t cache, long set_index) {
+    return (long*)(cache.meta + set_index * cache.set_stride);
+}
+
+static inline uchar* soa_frequency(soa_cache_t cache, long set_index) {
+    return cache.meta + set_index * cache.set_stride + cache.E * sizeof(long);
+}
+
+static inline uchar* soa_valid(soa_cache_t cache, long set_index) {
+    return soa_frequency(cache, set_index) + cache.E;
+}
+
+static inline uchar* soa_block(soa_cache_t cache, long set_index, int line) {
+    return cache.data + ((set_index * cache.E + line) << cache.b);
+}
+
+#endif
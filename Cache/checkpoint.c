@@ -0,0 +1,201 @@
+#include "checkpoint.h"
+#include "policy.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * @brief Returns the size of the metadata that precedes the block contents.
+ */
+static size_t metadata_size(long S, int E, uint64_t tree_words) {
+    return sizeof(checkpoint_header_t) + S * E * sizeof(checkpoint_line_t)
+        + S * sizeof(repl_set_t) + S * tree_words * sizeof(unsigned long);
+}
+
+/**
+ * @brief Writes the full state of a cache to a checkpoint file.
+ *
+ * Saves the geometry, write and replacement policy, every line's metadata,
+ * the replacement state and, unless the cache is metadata-only, the block
+ * contents in one contiguous slab.
+ *
+ * @param path Output file
+ * @param cache The cache to save
+ * @return 0 on success, -1 on failure
+ */
+int save_cache(const char* path, cache_t cache) {
+
+    long S = 1L << cache.s;
+    size_t B = (size_t)1 << cache.b;
+
+    FILE* out = fopen(path, "wb");
+    if (out == NULL) {
+        perror("cannot open checkpoint");
+        return -1;
+    }
+
+    checkpoint_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.s = cache.s;
+    header.t = cache.t;
+    header.b = cache.b;
+    header.E = cache.E;
+    header.write_policy = cache.write_policy;
+    header.metadata_only = cache.metadata_only;
+    strncpy(header.policy, cache.policy->name, sizeof(header.policy) - 1);
+    header.tree_words = cache.repl->tree_words;
+
+    size_t meta = metadata_size(S, cache.E, header.tree_words);
+    header.data_offset = (meta + CHECKPOINT_ALIGN - 1) & ~(size_t)(CHECKPOINT_ALIGN - 1);
+    header.data_size = cache.metadata_only ? 0 : S * cache.E * B;
+
+    fwrite(&header, sizeof(header), 1, out);
+
+    for (long i = 0; i < S; i++) {
+        for (int j = 0; j < cache.E; j++) {
+            cache_line_t* line = &cache.cache[i][j];
+            checkpoint_line_t record = {
+                line->tag, line->age, line->valid, line->dirty, line->state,
+                line->frequency, line->prefetched, {0}
+            };
+            fwrite(&record, sizeof(record), 1, out);
+        }
+    }
+
+    fwrite(cache.repl->sets, sizeof(repl_set_t), S, out);
+    fwrite(cache.repl->tree, sizeof(unsigned long), S * header.tree_words, out);
+
+    // Pad to the page boundary, then write the blocks in line order
+    for (size_t pos = meta; pos < header.data_offset; pos++) {
+        fputc(0, out);
+    }
+    for (long i = 0; i < S && !cache.metadata_only; i++) {
+        for (int j = 0; j < cache.E; j++) {
+            fwrite(cache.cache[i][j].block, 1, B, out);
+        }
+    }
+
+    if (ferror(out)) {
+        perror("checkpoint write failed");
+        fclose(out);
+        return -1;
+    }
+    return fclose(out) == 0 ? 0 : -1;
+}
+
+/**
+ * @brief Restores a cache from a checkpoint file.
+ *
+ * The file is memory-mapped privately. Line metadata and replacement state
+ * are copied out of the mapping, but the blocks are not: lines point
+ * straight into the mapped block slab, which is copy-on-write, so restoring
+ * a large cache only reads the pages the replay actually touches and never
+ * modifies the file.
+ *
+ * The geometry in the header must match the expected one; it is checked
+ * before any size is derived from it.
+ *
+ * @param path Checkpoint file
+ * @param s Expected number of set bits
+ * @param t Expected number of tag bits
+ * @param b Expected number of block bits
+ * @param E Expected number of lines per set
+ * @param cache Set to the restored cache (with zeroed statistics)
+ * @return 0 on success, -1 on failure
+ */
+int restore_cache(const char* path, uchar s, uchar t, uchar b, uchar E, cache_t* cache) {
+
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        perror("open checkpoint failed");
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(checkpoint_header_t)) {
+        fprintf(stderr, "%s is not a checkpoint\n", path);
+        close(fd);
+        return -1;
+    }
+
+    uchar* map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror("mmap checkpoint failed");
+        return -1;
+    }
+
+    checkpoint_header_t* header = (checkpoint_header_t*)map;
+
+    if (memcmp(header->magic, CHECKPOINT_MAGIC, sizeof(header->magic)) != 0
+        || header->version != CHECKPOINT_VERSION) {
+        fprintf(stderr, "%s is not a valid checkpoint\n", path);
+        munmap(map, st.st_size);
+        return -1;
+    }
+
+    if (header->s != s || header->t != t || header->b != b || header->E != E) {
+        fprintf(stderr, "Checkpoint geometry is s=%d t=%d b=%d E=%d\n",
+            header->s, header->t, header->b, header->E);
+        munmap(map, st.st_size);
+        return -1;
+    }
+
+    long S = 1L << header->s;
+    size_t B = (size_t)1 << header->b;
+
+    // The policy name must be terminated inside the header before it is looked up
+    const repl_policy_t* policy = memchr(header->policy, '\0', sizeof(header->policy))
+        ? find_policy(header->policy) : NULL;
+
+    if (policy == NULL
+        || header->data_size != (header->metadata_only ? 0 : (uint64_t)S * header->E * B)
+        || header->data_offset > (uint64_t)st.st_size
+        || header->data_size > (uint64_t)st.st_size - header->data_offset
+        || metadata_size(S, header->E, header->tree_words) > header->data_offset) {
+        fprintf(stderr, "%s is not a valid checkpoint\n", path);
+        munmap(map, st.st_size);
+        return -1;
+    }
+
+    // Build the structures without block storage; the blocks come from the mapping
+    cache_t c = initialize_cache_storage(header->s, header->t, header->b, header->E, policy, 1);
+    c.write_policy = header->write_policy;
+    c.metadata_only = header->metadata_only;
+
+    if (c.repl->tree_words != (int)header->tree_words) {
+        fprintf(stderr, "%s is not a valid checkpoint\n", path);
+        munmap(map, st.st_size);
+        return -1;
+    }
+
+    checkpoint_line_t* record = (checkpoint_line_t*)(map + sizeof(checkpoint_header_t));
+    uchar* blocks = map + header->data_offset;
+
+    for (long i = 0; i < S; i++) {
+        for (int j = 0; j < c.E; j++, record++) {
+            cache_line_t* line = &c.cache[i][j];
+            line->tag = record->tag;
+            line->age = record->age;
+            line->valid = record->valid;
+            line->dirty = record->dirty;
+            line->state = record->state;
+            line->frequency = record->frequency;
+            line->prefetched = record->prefetched;
+            line->block = c.metadata_only ? NULL : blocks + ((size_t)i * c.E + j) * B;
+        }
+    }
+
+    repl_set_t* sets = (repl_set_t*)record;
+    memcpy(c.repl->sets, sets, S * sizeof(repl_set_t));
+    memcpy(c.repl->tree, sets + S, S * header->tree_words * sizeof(unsigned long));
+
+    *cache = c;
+    return 0;
+}
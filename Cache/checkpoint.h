@@ -0,0 +1,47 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include "cache.h"
+
+#define CHECKPOINT_MAGIC "CSIMCKPT"
+#define CHECKPOINT_VERSION 1
+#define CHECKPOINT_ALIGN 4096 // Block data starts on a page boundary so it can be mapped
+
+/*
+ * Checkpoint file layout (native byte order):
+ *
+ *   checkpoint_header_t
+ *   checkpoint_line_t[S * E]        line metadata, set by set
+ *   repl_set_t[S]                   per-set replacement counters
+ *   unsigned long[S * tree_words]   tree-PLRU bits
+ *   padding to CHECKPOINT_ALIGN
+ *   uchar[S * E * B]                block contents (absent in metadata-only caches)
+ *
+ * Statistics, main memory and attached prefetchers, victim caches or TLBs are
+ * not saved: a restored cache starts with zeroed counters.
+ */
+typedef struct checkpoint_header_s {
+    char magic[8];
+    uint32_t version;
+    uint8_t s, t, b, E;
+    uint8_t write_policy;
+    uint8_t metadata_only;
+    uint8_t pad[2];
+    char policy[16];          // Replacement policy name
+    uint64_t tree_words;      // Tree-PLRU words per set
+    uint64_t data_offset;     // File offset of the block contents
+    uint64_t data_size;       // Bytes of block contents
+} checkpoint_header_t;
+
+typedef struct checkpoint_line_s {
+    int64_t tag;
+    uint64_t age;
+    uint8_t valid, dirty, state, frequency, prefetched;
+    uint8_t pad[3];
+} checkpoint_line_t;
+
+int save_cache(const char* path, cache_t cache);
+int restore_cache(const char* path, uchar s, uchar t, uchar b, uchar E, cache_t* cache);
+
+#endif
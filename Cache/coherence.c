@@ -0,0 +1,349 @@
+#include "coherence.h"
+#include "stats.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Creates N private caches kept coherent by a snooping protocol.
+ *
+ * Coherence protocols assume write-back caches, so every cache is
+ * write-back and write-allocate.
+ *
+ * @param cores Number of cores (1 .. MAX_CORES)
+ * @param s Number of set index bits of each cache
+ * @param t Number of tag bits
+ * @param b Number of block offset bits
+ * @param E Number of lines per set
+ * @param policy Replacement policy of each cache
+ * @param protocol PROTOCOL_MESI or PROTOCOL_MOESI
+ * @return Pointer to the multi-core system
+ */
+smp_t* create_smp(int cores, uchar s, uchar t, uchar b, uchar E, const repl_policy_t* policy, protocol_t protocol) {
+
+    smp_t* smp = calloc(1, sizeof(smp_t));
+
+    smp->cores = cores;
+    smp->protocol = protocol;
+
+    for (int i = 0; i < cores; i++) {
+        smp->core[i] = initialize_cache_policy(s, t, b, E, policy);
+        smp->core[i].write_policy = WRITE_BACK | WRITE_ALLOCATE;
+    }
+
+    smp->bounces = malloc(sizeof(bounce_entry_t) * BOUNCE_TABLE_SIZE);
+    for (int i = 0; i < BOUNCE_TABLE_SIZE; i++) {
+        smp->bounces[i].block = -1;
+    }
+
+    return smp;
+}
+
+/**
+ * @brief Finds the bounce table entry of a block.
+ * @param smp The multi-core system
+ * @param block Block address
+ * @param insert Claim a free slot if the block is not tracked yet
+ * @return The entry, or NULL if the block is not tracked (or the table is full)
+ */
+static bounce_entry_t* bounce_entry(smp_t* smp, long block, int insert) {
+
+    unsigned long i = ((unsigned long)block * 0x9E3779B97F4A7C15UL) >> 48;
+
+    while (1) {
+        bounce_entry_t* e = &smp->bounces[i & (BOUNCE_TABLE_SIZE - 1)];
+
+        if (e->block == block) {
+            return e;
+        }
+        if (e->block == -1) {
+            // Keep a quarter of the table free so probes stay short
+            if (!insert || smp->tracked >= BOUNCE_TABLE_SIZE / 4 * 3) {
+                return NULL;
+            }
+            memset(e, 0, sizeof(bounce_entry_t));
+            e->block = block;
+            smp->tracked++;
+            return e;
+        }
+        i++;
+    }
+}
+
+/**
+ * @brief Records which part of a tracked block a core accessed.
+ *
+ * Only blocks that have already bounced are tracked. The block is split
+ * into 64 chunks (or one per byte for smaller blocks); cores touching
+ * disjoint chunks of a bouncing block are false sharing.
+ *
+ * @param smp The multi-core system
+ * @param core Issuing core
+ * @param off Memory address offset
+ * @param write Whether the access is a write
+ */
+static void record_touch(smp_t* smp, int core, long int off, int write) {
+
+    cache_t c = smp->core[core];
+    bounce_entry_t* e = bounce_entry(smp, off & ~c.offset_mask, 0);
+
+    if (e == NULL) {
+        return;
+    }
+
+    int chunk_bits = c.b > 6 ? c.b - 6 : 0;
+    e->touched[core] |= 1UL << ((off & c.offset_mask) >> chunk_bits);
+    if (write) {
+        e->writers |= 1U << core;
+    }
+}
+
+/**
+ * @brief Invalidates another core's copy of a block (bus read-for-ownership
+ *        or upgrade). A dirty copy is written back first.
+ * @param smp The multi-core system
+ * @param victim Core whose copy is dropped
+ * @param start Pointer to the start of main memory
+ * @param off Memory address offset
+ * @return 1 if the core held the block
+ */
+static int snoop_invalidate(smp_t* smp, int victim, uchar* start, long int off) {
+
+    cache_t c = smp->core[victim];
+    cache_line_t* line = find_line(c, off);
+
+    if (line == NULL) {
+        return 0;
+    }
+
+    if (line->dirty) {
+        smp->transfers++;
+    }
+
+    write_back_line(c, start, decode_address(c, off).set_index, line);
+    line->valid = 0;
+    line->frequency = 0;
+    line->state = COH_INVALIDATED;
+
+    smp->stats[victim].invalidations++;
+
+    bounce_entry_t* e = bounce_entry(smp, off & ~c.offset_mask, 1);
+    if (e != NULL) {
+        e->invalidations++;
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Checks whether a miss is on a block another core took away.
+ * @param c The cache structure
+ * @param off Memory address offset
+ * @return 1 if the set still holds the invalidated tag
+ */
+static int is_coherence_miss(cache_t c, long int off) {
+
+    address_t a = decode_address(c, off);
+    cache_line_t* set = c.cache[a.set_index];
+
+    for (int i = 0; i < c.E; i++) {
+        if (!set[i].valid && set[i].state == COH_INVALIDATED && set[i].tag == a.tag) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Reads a byte on one core.
+ *
+ * A miss issues a bus read. Other caches holding the block drop to Shared;
+ * a Modified copy is written back (MESI) or becomes Owned and supplies the
+ * data (MOESI). The requester gets the block Exclusive if nobody else has
+ * it, Shared otherwise.
+ *
+ * @param smp The multi-core system
+ * @param core Issuing core
+ * @param start Pointer to the start of main memory
+ * @param off The memory address offset to read
+ * @return The byte value read
+ */
+uchar smp_read_byte(smp_t* smp, int core, uchar* start, long int off) {
+
+    cache_t me = smp->core[core];
+    cache_line_t* supplier = NULL;
+    int shared = 0, status;
+    long evicted;
+
+    if (find_line(me, off) == NULL) {
+        smp->bus_reads++;
+        if (is_coherence_miss(me, off)) {
+            smp->stats[core].coherence_misses++;
+        }
+
+        // Snoop the other caches
+        for (int i = 0; i < smp->cores; i++) {
+            cache_line_t* line = i == core ? NULL : find_line(smp->core[i], off);
+            if (line == NULL) {
+                continue;
+            }
+
+            shared = 1;
+            switch (line->state)
+            {
+                case COH_MODIFIED:
+                    if (smp->protocol == PROTOCOL_MOESI) {
+                        line->state = COH_OWNED;
+                        supplier = line;
+                    } else {
+                        write_back_line(smp->core[i], start, decode_address(me, off).set_index, line);
+                        line->state = COH_SHARED;
+                        smp->transfers++;
+                    }
+                    break;
+
+                case COH_OWNED:
+                    supplier = line;
+                    break;
+
+                case COH_EXCLUSIVE:
+                    line->state = COH_SHARED;
+                    break;
+
+                default:
+                    break;
+            }
+        }
+    }
+
+    cache_line_t* line = fetch_line(me, start, off, &status, &evicted);
+
+    if (status != CACHE_HIT) {
+        // An Owned copy is newer than memory and is forwarded cache-to-cache
+        if (supplier != NULL) {
+            memcpy(line->block, supplier->block, (size_t)1 << me.b);
+            smp->transfers++;
+        }
+        line->state = shared ? COH_SHARED : COH_EXCLUSIVE;
+    }
+
+    record_touch(smp, core, off, 0);
+    return line->block[off & me.offset_mask];
+}
+
+/**
+ * @brief Writes a byte on one core.
+ *
+ * A write to a Shared or Owned line broadcasts an upgrade and a write miss
+ * broadcasts a read-for-ownership; both invalidate every other copy (dirty
+ * copies are written back first). The line ends up Modified.
+ *
+ * @param smp The multi-core system
+ * @param core Issuing core
+ * @param start Pointer to main memory
+ * @param off Memory address offset
+ * @param new New byte value to write
+ */
+void smp_write_byte(smp_t* smp, int core, uchar* start, long int off, uchar new) {
+
+    cache_t me = smp->core[core];
+    cache_line_t* line = find_line(me, off);
+
+    if (line == NULL) {
+        smp->bus_read_excl++;
+        if (is_coherence_miss(me, off)) {
+            smp->stats[core].coherence_misses++;
+        }
+    } else if (line->state == COH_SHARED || line->state == COH_OWNED) {
+        smp->stats[core].upgrades++;
+    }
+
+    // Anything but an Exclusive or Modified hit needs the other copies gone
+    if (line == NULL || line->state == COH_SHARED || line->state == COH_OWNED) {
+        for (int i = 0; i < smp->cores; i++) {
+            if (i != core) {
+                snoop_invalidate(smp, i, start, off);
+            }
+        }
+    }
+
+    write_byte(me, start, off, new);
+    find_line(me, off)->state = COH_MODIFIED;
+
+    record_touch(smp, core, off, 1);
+}
+
+/**
+ * @brief Compares bounce entries by invalidations, most first (for qsort).
+ * @param a Pointer to the first entry pointer
+ * @param b Pointer to the second entry pointer
+ * @return Negative, zero or positive as for qsort
+ */
+static int cmp_bounces(const void* a, const void* b) {
+    const bounce_entry_t* x = *(const bounce_entry_t* const*)a;
+    const bounce_entry_t* y = *(const bounce_entry_t* const*)b;
+    return (y->invalidations > x->invalidations) - (y->invalidations < x->invalidations);
+}
+
+/**
+ * @brief Tells whether the cores touching a block never touch the same chunk.
+ * @param smp The multi-core system
+ * @param e Bounce table entry
+ * @return 1 if the block is falsely shared
+ */
+static int is_false_sharing(smp_t* smp, bounce_entry_t* e) {
+
+    unsigned long seen = 0, overlap = 0;
+    int users = 0;
+
+    for (int i = 0; i < smp->cores; i++) {
+        if (e->touched[i]) {
+            overlap |= seen & e->touched[i];
+            seen |= e->touched[i];
+            users++;
+        }
+    }
+    return users > 1 && !overlap;
+}
+
+/**
+ * @brief Prints per-core statistics, bus traffic and the most-bounced blocks.
+ * @param out Output stream
+ * @param smp The multi-core system
+ */
+void print_smp_summary(FILE* out, smp_t* smp) {
+
+    fprintf(out, "── %d cores, %s ──\n", smp->cores, smp->protocol == PROTOCOL_MOESI ? "MOESI" : "MESI");
+
+    for (int i = 0; i < smp->cores; i++) {
+        const cache_stats_t* st = smp->core[i].stats;
+        unsigned long accesses = total_accesses(st);
+
+        fprintf(out, "Core %-2d  : %lu accesses, %lu misses (%lu coherence), %lu invalidated, %lu upgrades\n",
+            i, accesses, total_misses(st), smp->stats[i].coherence_misses,
+            smp->stats[i].invalidations, smp->stats[i].upgrades);
+    }
+
+    fprintf(out, "Bus      : %lu reads, %lu read-for-ownership, %lu cache-to-cache transfers\n",
+        smp->bus_reads, smp->bus_read_excl, smp->transfers);
+
+    // Rank the tracked blocks by how often they were stolen
+    bounce_entry_t** ranked = malloc(sizeof(bounce_entry_t*) * (smp->tracked + 1));
+    unsigned long n = 0;
+
+    for (int i = 0; i < BOUNCE_TABLE_SIZE; i++) {
+        if (smp->bounces[i].block != -1) {
+            ranked[n++] = &smp->bounces[i];
+        }
+    }
+    qsort(ranked, n, sizeof(bounce_entry_t*), cmp_bounces);
+
+    fprintf(out, "Bouncing : %lu blocks moved between cores\n", n);
+
+    for (unsigned long i = 0; i < n && i < BOUNCE_REPORT; i++) {
+        bounce_entry_t* e = ranked[i];
+        fprintf(out, "  0x%08lx  %8lu invalidations, writers 0x%04x%s\n", e->block,
+            e->invalidations, e->writers, is_false_sharing(smp, e) ? "  (false sharing)" : "");
+    }
+
+    free(ranked);
+}
@@ -0,0 +1,54 @@
+#ifndef COHERENCE_H
+#define COHERENCE_H
+
+#include <stdio.h>
+#include "cache.h"
+
+#define MAX_CORES 16
+#define BOUNCE_TABLE_SIZE (1 << 16) // Tracked blocks (power of two)
+#define BOUNCE_REPORT 10            // Most-bounced blocks in the report
+
+/* cache_line_t.state values */
+#define COH_INVALID 0     // Not present (or never used)
+#define COH_SHARED 1      // Clean, other caches may hold it
+#define COH_EXCLUSIVE 2   // Clean, no other cache holds it
+#define COH_MODIFIED 3    // Dirty, no other cache holds it
+#define COH_OWNED 4       // Dirty, other caches may hold it (MOESI only)
+#define COH_INVALIDATED 5 // Invalid because another core wrote the block (tag kept)
+
+typedef enum {
+    PROTOCOL_MESI,
+    PROTOCOL_MOESI
+} protocol_t;
+
+typedef struct core_stats_s {
+    unsigned long coherence_misses; // Misses on blocks another core invalidated
+    unsigned long invalidations;    // Lines invalidated by another core's write
+    unsigned long upgrades;         // Writes to Shared/Owned lines
+} core_stats_t;
+
+typedef struct bounce_entry_s {
+    long block;                       // Block address, -1 if the slot is empty
+    unsigned long invalidations;      // Times the block was stolen from a core
+    unsigned long touched[MAX_CORES]; // Chunks of the block each core accessed
+    unsigned int writers;             // Bit mask of cores that wrote the block
+} bounce_entry_t;
+
+typedef struct smp_s {
+    int cores;
+    protocol_t protocol;
+    cache_t core[MAX_CORES];      // Private caches, write-back and write-allocate
+    core_stats_t stats[MAX_CORES];
+    unsigned long bus_reads;      // Read misses put on the bus
+    unsigned long bus_read_excl;  // Write misses put on the bus (read for ownership)
+    unsigned long transfers;      // Dirty blocks supplied cache-to-cache
+    unsigned long tracked;        // Used slots in bounces
+    bounce_entry_t* bounces;      // Open-addressing table of blocks that moved between cores
+} smp_t;
+
+smp_t* create_smp(int cores, uchar s, uchar t, uchar b, uchar E, const repl_policy_t* policy, protocol_t protocol);
+uchar smp_read_byte(smp_t* smp, int core, uchar* start, long int off);
+void smp_write_byte(smp_t* smp, int core, uchar* start, long int off, uchar new);
+void print_smp_summary(FILE* out, smp_t* smp);
+
+#endif
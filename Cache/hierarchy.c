@@ -0,0 +1,304 @@
+#include "hierarchy.h"
+#include "policy.h"
+#include "stats.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Chains caches into a hierarchy, L1 first.
+ *
+ * Every level must use the same block size. Memory is accessed through the
+ * last level. Each level gets a spill line: the lines it evicts or
+ * invalidates are handed to the next level instead of main memory.
+ *
+ * @param levels Caches from L1 outwards
+ * @param num_levels Number of caches (1 .. MAX_LEVELS)
+ * @param mode HIERARCHY_INCLUSIVE or HIERARCHY_EXCLUSIVE
+ * @return The hierarchy (by value)
+ */
+hierarchy_t create_hierarchy(cache_t levels[], int num_levels, hierarchy_mode_t mode) {
+
+    hierarchy_t h;
+
+    h.levels = num_levels;
+    h.mode = mode;
+
+    for (int i = 0; i < num_levels; i++) {
+        h.level[i] = levels[i];
+        h.level[i].spill = calloc(1, sizeof(cache_line_t));
+        h.level[i].spill->block = levels[i].metadata_only ? NULL : malloc((size_t)1 << levels[i].b);
+    }
+
+    return h;
+}
+
+/**
+ * @brief Passes the line in a level's spill line to the levels below it.
+ *
+ * Inclusive: a dirty line updates the first lower level holding the block,
+ * which becomes dirty, or main memory if none does. A clean line is dropped.
+ * Exclusive: the line moves into the next level with its dirty bit, and
+ * that level's victim moves on in turn. The last level writes dirty lines
+ * to main memory. A dirty line counts as a write-back of its level.
+ *
+ * @param h The hierarchy
+ * @param start Pointer to main memory
+ * @param i Level whose spill line holds the block
+ * @param addr Address of the block
+ */
+static void spill_down(hierarchy_t* h, uchar* start, int i, long addr) {
+
+    cache_t level = h->level[i];
+    cache_line_t* victim = level.spill;
+    size_t B = (size_t)1 << level.b;
+    long evicted;
+
+    if (victim->dirty) {
+        level.stats->write_backs++;
+    }
+
+    if (h->mode == HIERARCHY_EXCLUSIVE && i + 1 < h->levels) {
+        place_block(h->level[i + 1], start, addr, victim->block, victim->dirty, &evicted);
+        if (evicted >= 0) {
+            spill_down(h, start, i + 1, evicted);
+        }
+        return;
+    }
+
+    if (!victim->dirty) {
+        return;
+    }
+
+    for (int j = i + 1; j < h->levels; j++) {
+        cache_line_t* line = find_line(h->level[j], addr);
+        if (line != NULL) {
+            memcpy(line->block, victim->block, B);
+            line->dirty = 1;
+            return;
+        }
+    }
+
+    memcpy(start + addr, victim->block, B);
+}
+
+/**
+ * @brief Inclusive access: walks down until a level hits.
+ *
+ * Each level that misses fills the block, then takes the copy of the level
+ * that hit, which may be newer than main memory. When
+ * a level evicts a block, its copy goes down first, then the block is
+ * invalidated in every level above it (bottom up, so the newest dirty copy
+ * lands last) so inclusion holds.
+ *
+ * @return The L1 line holding the block
+ */
+static cache_line_t* inclusive_access(hierarchy_t* h, uchar* start, long int off, int is_write) {
+
+    cache_line_t* lines[MAX_LEVELS];
+    int status, i;
+    long evicted;
+
+    for (i = 0; i < h->levels; i++) {
+        lines[i] = access_line(h->level[i], start, off, is_write, &status, &evicted);
+
+        if (evicted >= 0) {
+            spill_down(h, start, i, evicted);
+
+            // Back-invalidate the victim from the levels above
+            for (int j = i - 1; j >= 0; j--) {
+                if (invalidate_block(h->level[j], start, evicted)) {
+                    spill_down(h, start, j, evicted);
+                }
+            }
+        }
+
+        if (status == CACHE_HIT) {
+            break;
+        }
+    }
+
+    // The level that hit may be newer than memory (dirty here or below): pass it up
+    if (i > 0 && i < h->levels) {
+        for (int j = 0; j < i; j++) {
+            memcpy(lines[j]->block, lines[i]->block, (size_t)1 << h->level[0].b);
+        }
+    }
+
+    return lines[0];
+}
+
+/**
+ * @brief Exclusive access: the block moves up to L1, victims move down.
+ *
+ * On an L1 miss the lower levels are probed in order. A level that holds the
+ * block gives it up (it is counted as a hit there), the levels in between
+ * count a miss, and the block moves into L1 with its contents and dirty bit.
+ * Otherwise L1 fills it from memory. The line L1 evicts moves into L2, the
+ * line L2 evicts into L3, and so on; the last level's victim leaves the
+ * hierarchy.
+ *
+ * @return The L1 line holding the block
+ */
+static cache_line_t* exclusive_access(hierarchy_t* h, uchar* start, long int off, int is_write) {
+
+    cache_t l1 = h->level[0];
+    cache_line_t* line;
+    int status, src = 0;
+    long evicted;
+
+    // On an L1 miss, take the block out of the first lower level holding it
+    if (probe_block(l1, off) != CACHE_HIT) {
+        for (int i = 1; i < h->levels; i++) {
+            cache_t level = h->level[i];
+            int found = probe_block(level, off);
+
+            record_access(level.stats, decode_address(level, off).set_index, is_write, found);
+
+            if (found == CACHE_HIT) {
+                invalidate_block(level, start, off);
+                src = i;
+                break;
+            }
+        }
+    }
+
+    if (src > 0) {
+        address_t addr_type = decode_address(l1, off);
+        cache_line_t* moved = h->level[src].spill;
+
+        record_access(l1.stats, addr_type.set_index, is_write, probe_block(l1, off));
+        line = l1.cache[addr_type.set_index]
+            + place_block(l1, start, off, moved->block, moved->dirty, &evicted);
+    } else {
+        line = access_line(l1, start, off, is_write, &status, &evicted);
+    }
+
+    // Cascade victims down the hierarchy
+    if (evicted >= 0) {
+        spill_down(h, start, 0, evicted);
+    }
+
+    return line;
+}
+
+/**
+ * @brief Reads a byte through the hierarchy.
+ * @param h The hierarchy
+ * @param start Pointer to the start of main memory
+ * @param off The memory address offset to read
+ * @return The byte value read
+ */
+uchar hierarchy_read_byte(hierarchy_t* h, uchar* start, long int off) {
+
+    cache_line_t* line = h->mode == HIERARCHY_EXCLUSIVE
+        ? exclusive_access(h, start, off, 0)
+        : inclusive_access(h, start, off, 0);
+
+    return line->block[off & h->level[0].offset_mask];
+}
+
+/**
+ * @brief Writes a byte through the hierarchy.
+ *
+ * With WRITE_ALLOCATE (taken from L1) a miss first brings the block in
+ * exactly like a read, counted as a write. The byte is then applied level
+ * by level: a level holding the block updates its copy, and a write-back
+ * level marks it dirty and stops there; the levels below only see the data
+ * when the dirty line is evicted. Without WRITE_ALLOCATE a level that
+ * misses writes around itself. A write that passes every level reaches
+ * main memory, and each level it passed counts a write-through.
+ *
+ * @param h The hierarchy
+ * @param start Pointer to main memory
+ * @param off Memory address offset
+ * @param new New byte value to write
+ */
+void hierarchy_write_byte(hierarchy_t* h, uchar* start, long int off, uchar new) {
+
+    int allocate = h->level[0].write_policy & WRITE_ALLOCATE;
+
+    if (allocate) {
+        if (h->mode == HIERARCHY_EXCLUSIVE) {
+            exclusive_access(h, start, off, 1);
+        } else {
+            inclusive_access(h, start, off, 1);
+        }
+    }
+
+    for (int i = 0; i < h->levels; i++) {
+        cache_t level = h->level[i];
+        address_t addr_type = decode_address(level, off);
+        cache_line_t* set = level.cache[addr_type.set_index];
+        int line_index = 0;
+        int status = level.lookup(set, level.E, addr_type.tag, &line_index);
+
+        // The allocating access above already counted the write
+        if (!allocate) {
+            record_access(level.stats, addr_type.set_index, 1, status);
+            if (status == CACHE_HIT) {
+                level.policy->on_hit(&level, addr_type.set_index, line_index);
+            }
+        }
+
+        if (status == CACHE_HIT) {
+            set[line_index].block[addr_type.offset] = new;
+            if (level.write_policy & WRITE_BACK) {
+                set[line_index].dirty = 1;
+                return;
+            }
+        }
+
+        level.stats->write_throughs++;
+    }
+
+    start[off] = new;
+}
+
+/**
+ * @brief Prints one summary block per level.
+ * @param out Output stream
+ * @param h The hierarchy
+ */
+void print_hierarchy_summary(FILE* out, hierarchy_t* h) {
+    for (int i = 0; i < h->levels; i++) {
+        cache_t c = h->level[i];
+        fprintf(out, "── L%d (s=%d E=%d b=%d, %s) ──\n", i + 1, c.s, c.E, c.b,
+            h->mode == HIERARCHY_EXCLUSIVE ? "exclusive" : "inclusive");
+        print_stats_summary(out, c);
+    }
+}
+
+/**
+ * @brief Prints the statistics of every level as a JSON array, L1 first.
+ * @param out Output stream
+ * @param h The hierarchy
+ */
+void print_hierarchy_json(FILE* out, hierarchy_t* h) {
+    fprintf(out, "[\n");
+    for (int i = 0; i < h->levels; i++) {
+        print_stats_json(out, h->level[i]);
+        if (i + 1 < h->levels) {
+            fprintf(out, ",\n");
+        }
+    }
+    fprintf(out, "]\n");
+}
+
+/**
+ * @brief Prints the per-set heatmap of every level as one CSV table.
+ *
+ * Same columns as print_stats_csv with a leading level column (1 = L1).
+ *
+ * @param out Output stream
+ * @param h The hierarchy
+ */
+void print_hierarchy_csv(FILE* out, hierarchy_t* h) {
+
+    char prefix[16];
+
+    fprintf(out, "level,set,hits,misses,evictions,miss_rate\n");
+    for (int i = 0; i < h->levels; i++) {
+        snprintf(prefix, sizeof(prefix), "%d,", i + 1);
+        print_stats_csv_rows(out, h->level[i], prefix);
+    }
+}
@@ -0,0 +1,27 @@
+#ifndef HIERARCHY_H
+#define HIERARCHY_H
+
+#include <stdio.h>
+#include "cache.h"
+
+#define MAX_LEVELS 4 // L1 .. L4
+
+typedef enum {
+    HIERARCHY_INCLUSIVE, // Every level holds a superset of the level above it
+    HIERARCHY_EXCLUSIVE  // A block lives in at most one level
+} hierarchy_mode_t;
+
+typedef struct hierarchy_s {
+    int levels;
+    hierarchy_mode_t mode;
+    cache_t level[MAX_LEVELS]; // level[0] is L1, closest to the CPU
+} hierarchy_t;
+
+hierarchy_t create_hierarchy(cache_t levels[], int num_levels, hierarchy_mode_t mode);
+uchar hierarchy_read_byte(hierarchy_t* h, uchar* start, long int off);
+void hierarchy_write_byte(hierarchy_t* h, uchar* start, long int off, uchar new);
+void print_hierarchy_summary(FILE* out, hierarchy_t* h);
+void print_hierarchy_json(FILE* out, hierarchy_t* h);
+void print_hierarchy_csv(FILE* out, hierarchy_t* h);
+
+#endif
@@ -0,0 +1,723 @@
+#include "cache.h"
+#include "trace.h"
+#include "cache_soa.h"
+#include "tagmatch.h"
+#include "policy.h"
+#include "stats.h"
+#include "hierarchy.h"
+#include "parallel.h"
+#include "coherence.h"
+#include "prefetch.h"
+#include "mrc.h"
+#include "victim.h"
+#include "tlb.h"
+#include "checkpoint.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define MAX_ADDRESS_BITS 46 // Largest simulated address space (s + t + b) in batch mode
+
+typedef struct options_s {
+    char* path;                   // Trace file
+    trace_format_t format;
+    int s, t, b, E;               // Cache geometry
+    const repl_policy_t* policy;  // Replacement policy (pointer-based engine)
+    const prefetcher_t* prefetcher; // Hardware prefetcher, NULL = none
+    int victim_entries;           // Victim / miss cache entries, 0 = none
+    victim_mode_t victim_mode;
+    int tlb_entries, tlb_ways;    // TLB geometry, 0 entries = no translation
+    int page_bits;                // PAGE_BITS_4K or PAGE_BITS_2M
+    index_mode_t index_mode;      // PIPT or VIPT cache indexing behind the TLB
+    int write_policy;             // WRITE_BACK / WRITE_ALLOCATE flags of every level
+    int policy_given, write_given; // -p / -W on the command line (checked against -r)
+    int rate_given;               // -R on the command line (only valid with -m)
+    int soa;                      // Use the structure-of-arrays engine
+    char* kernel;                 // Tag match kernel of -S (-K), NULL = best supported
+    int metadata_only;            // Track tags only, without block data
+    int verbose;                  // Print the cache contents after the replay
+    char* json_path;              // Statistics output (JSON), "-" for stdout
+    char* csv_path;               // Per-set statistics output (CSV), "-" for stdout
+    char* mrc_path;               // Miss-ratio curve output (CSV), "-" for stdout
+    char* save_path;              // Checkpoint written after the replay
+    char* restore_path;           // Checkpoint the replay starts from
+    double sample_rate;           // SHARDS sampling rate of the miss-ratio curve
+    int num_levels;               // Cache levels, L1 included
+    int level_s[MAX_LEVELS];      // Set bits of each lower level (-L)
+    int level_E[MAX_LEVELS];      // Lines per set of each lower level (-L)
+    const repl_policy_t* level_policy[MAX_LEVELS];
+    hierarchy_mode_t mode;        // Inclusive or exclusive hierarchy
+    int workers;                  // Worker threads, 0 = serial replay
+    int cores;                    // Coherent private caches, 0 = single cache
+    protocol_t protocol;          // Coherence protocol of the cores
+} options_t;
+
+/**
+ * @brief Prints the command line usage.
+ * @param prog Program name
+ */
+void usage(char* prog) {
+    fprintf(stderr, "Usage: %s                                  (interactive)\n", prog);
+    fprintf(stderr, "       %s -s <s> -t <t> -b <b> -E <E> -f <trace> [-l] [-p policy] [-F prefetcher] [-V n[:miss]] [-T tlb] [-W write] [-P n] [-M]\n", prog);
+    fprintf(stderr, "       %*s [-L s:E[:policy]]... [-x] [-C n[:moesi]] [-S [-K kernel]] [-j file] [-c file]\n", (int)strlen(prog), "");
+    fprintf(stderr, "       %*s [-m file [-R rate]] [-r checkpoint] [-k checkpoint] [-v]\n", (int)strlen(prog), "");
+    fprintf(stderr, "  -f <trace>  Replay a trace file in batch mode\n");
+    fprintf(stderr, "  -l          Trace is Valgrind lackey text (default: binary)\n");
+    fprintf(stderr, "  -p <policy> Replacement policy (default: frequency): ");
+    list_policies(stderr);
+    fprintf(stderr, "\n");
+    fprintf(stderr, "  -F <pf>     Hardware prefetcher: ");
+    list_prefetchers(stderr);
+    fprintf(stderr, "\n");
+    fprintf(stderr, "  -V <n>      Attach an n-entry victim cache (n:miss for a miss cache)\n");
+    fprintf(stderr, "  -T <tlb>    Translate through a TLB: entries:ways[:4k|2m][:pipt|vipt]\n");
+    fprintf(stderr, "  -W <write>  Write policy: through (default), through-allocate,\n");
+    fprintf(stderr, "              back (write-back, write-allocate) or back-noallocate\n");
+    fprintf(stderr, "  -P <n>      Replay with n worker threads, sets partitioned between them\n");
+    fprintf(stderr, "  -M          Metadata only: hit/miss statistics without block contents\n");
+    fprintf(stderr, "  -S          Use the structure-of-arrays storage engine (frequency policy only)\n");
+    fprintf(stderr, "  -K <kernel> Tag match kernel for -S: scalar, sse2 or avx2 (default: best)\n");
+    fprintf(stderr, "  -L <level>  Add a lower cache level (L2, L3, ...) as s:E[:policy]\n");
+    fprintf(stderr, "  -x          Exclusive hierarchy (default: inclusive)\n");
+    fprintf(stderr, "  -C <cores>  Simulate n coherent private caches (MESI, or MOESI with n:moesi)\n");
+    fprintf(stderr, "  -j <file>   Write statistics as JSON (\"-\" for stdout)\n");
+    fprintf(stderr, "  -c <file>   Write the per-set heatmap as CSV (\"-\" for stdout)\n");
+    fprintf(stderr, "  -m <file>   Write LRU miss-ratio curves up to (2^s sets, E ways) as CSV\n");
+    fprintf(stderr, "  -R <rate>   Sample this fraction of the sets for -m (default: 1 = exact)\n");
+    fprintf(stderr, "  -r <file>   Start from a saved cache state instead of a cold cache\n");
+    fprintf(stderr, "  -k <file>   Save the cache state after the replay\n");
+    fprintf(stderr, "  -v          Print the cache contents after the replay\n");
+}
+
+/**
+ * @brief Returns the current monotonic time in seconds.
+ */
+double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Forces the tag match kernel named on the command line.
+ * @param name Kernel name: scalar, sse2 or avx2
+ * @return 0 on success, -1 if the name is unknown or the CPU lacks support
+ */
+int parse_tag_kernel(char* name) {
+    tag_kernel_t kernels[] = {KERNEL_SCALAR, KERNEL_SSE2, KERNEL_AVX2};
+
+    for (int i = 0; i < 3; i++) {
+        if (strcmp(name, tag_kernel_name(kernels[i])) == 0) {
+            return use_tag_kernel(kernels[i]);
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Interactive mode: reads memory, initializes cache, and simulates cache accesses.
+ *
+ * Prompts for memory size and data, cache parameters, and a series of memory reads.
+ * Prints cache content at the end.
+ */
+int run_interactive() {
+
+    int n;
+    printf("Size of data: ");
+    scanf("%d", &n);
+
+    // Allocate memory
+    uchar* mem = malloc(n);
+    printf("Input data >> ");
+
+    for (int i = 0; i < n; i++)
+        scanf("%hhd", mem + i);
+
+    // Read cache parameters
+    int s, t, b, E;
+    printf("s t b E: ");
+    scanf("%d %d %d %d", &s, &t, &b, &E);
+
+    // Initialize cache
+    cache_t cache = initialize_cache(s, t, b, E);
+
+    // Simulate cache reads until negative number is entered
+    while (1) {
+        scanf("%d", &n);
+        if (n < 0) break;
+        read_byte(cache, mem, n);
+    }
+
+    // Print cache contents
+    puts("");
+    print_cache(cache);
+
+    // Free allocated memory
+    free(mem);
+    return 0;
+}
+
+/**
+ * @brief Opens a statistics output file.
+ * @param path Output file, or "-" for the standard output
+ * @return The stream, or NULL if the file cannot be opened
+ */
+FILE* open_output(char* path) {
+
+    if (strcmp(path, "-") == 0) {
+        return stdout;
+    }
+
+    FILE* out = fopen(path, "w");
+    if (out == NULL) {
+        perror("cannot open statistics file");
+    }
+    return out;
+}
+
+/**
+ * @brief Closes a stream returned by open_output.
+ */
+void close_output(FILE* out) {
+    if (out != stdout) {
+        fclose(out);
+    }
+}
+
+/**
+ * @brief Parses a write policy name (see write_policy_name).
+ * @param name through, through-allocate, back or back-noallocate
+ * @return WRITE_BACK / WRITE_ALLOCATE flags, or -1 if the name is unknown
+ */
+int parse_write_policy(char* name) {
+    for (int flags = 0; flags <= (WRITE_BACK | WRITE_ALLOCATE); flags++) {
+        if (strcmp(name, write_policy_name(flags)) == 0) {
+            return flags;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Parses a lower cache level given as "s:E" or "s:E:policy".
+ * @param spec Level specification from the command line
+ * @param opt Options to add the level to
+ * @return 0 on success, -1 on a malformed specification
+ */
+int parse_level(char* spec, options_t* opt) {
+
+    if (opt->num_levels == MAX_LEVELS) {
+        fprintf(stderr, "At most %d cache levels are supported\n", MAX_LEVELS);
+        return -1;
+    }
+
+    int i = opt->num_levels;
+    char name[32] = "";
+
+    if (sscanf(spec, "%d:%d:%31s", &opt->level_s[i], &opt->level_E[i], name) < 2
+        || opt->level_s[i] < 0 || opt->level_E[i] < 1 || opt->level_E[i] > 255) {
+        fprintf(stderr, "Malformed level %s (expected s:E[:policy])\n", spec);
+        return -1;
+    }
+
+    opt->level_policy[i] = name[0] ? find_policy(name) : &frequency_policy;
+    if (opt->level_policy[i] == NULL) {
+        fprintf(stderr, "Unknown replacement policy %s\n", name);
+        return -1;
+    }
+
+    opt->num_levels++;
+    return 0;
+}
+
+/**
+ * @brief Parses a victim buffer given as "n", "n:victim" or "n:miss".
+ * @param spec Buffer specification from the command line
+ * @param opt Options to store the entries and mode in
+ * @return 0 on success, -1 on a malformed specification
+ */
+int parse_victim(char* spec, options_t* opt) {
+
+    char name[16] = "victim";
+
+    if (sscanf(spec, "%d:%15s", &opt->victim_entries, name) < 1
+        || opt->victim_entries < 1 || opt->victim_entries > MAX_VICTIM_ENTRIES) {
+        fprintf(stderr, "Malformed victim cache %s (expected 1..%d[:victim|miss])\n", spec,
+            MAX_VICTIM_ENTRIES);
+        return -1;
+    }
+
+    if (strcmp(name, "victim") == 0) {
+        opt->victim_mode = VICTIM_CACHE;
+    } else if (strcmp(name, "miss") == 0) {
+        opt->victim_mode = MISS_CACHE;
+    } else {
+        fprintf(stderr, "Unknown victim cache mode %s\n", name);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Parses a TLB given as "entries:ways" followed by an optional page
+ *        size (4k, 2m) and cache indexing (pipt, vipt), in any order.
+ * @param spec TLB specification from the command line
+ * @param opt Options to store the TLB in
+ * @return 0 on success, -1 on a malformed specification
+ */
+int parse_tlb(char* spec, options_t* opt) {
+
+    char extra[2][16] = {"", ""};
+
+    opt->page_bits = PAGE_BITS_4K;
+    opt->index_mode = INDEX_PHYSICAL;
+
+    int n = sscanf(spec, "%d:%d:%15[^:]:%15s", &opt->tlb_entries, &opt->tlb_ways, extra[0], extra[1]);
+    int sets = opt->tlb_ways > 0 ? opt->tlb_entries / opt->tlb_ways : 0;
+
+    if (n < 2 || opt->tlb_ways < 1 || sets < 1 || sets * opt->tlb_ways != opt->tlb_entries
+        || (sets & (sets - 1))) {
+        fprintf(stderr, "Malformed TLB %s (expected entries:ways[:4k|2m][:pipt|vipt],"
+            " with a power-of-two set count)\n", spec);
+        return -1;
+    }
+
+    for (int i = 0; i < n - 2; i++) {
+        if (strcmp(extra[i], "4k") == 0) {
+            opt->page_bits = PAGE_BITS_4K;
+        } else if (strcmp(extra[i], "2m") == 0) {
+            opt->page_bits = PAGE_BITS_2M;
+        } else if (strcmp(extra[i], "pipt") == 0) {
+            opt->index_mode = INDEX_PHYSICAL;
+        } else if (strcmp(extra[i], "vipt") == 0) {
+            opt->index_mode = INDEX_VIRTUAL;
+        } else {
+            fprintf(stderr, "Unknown TLB option %s\n", extra[i]);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Parses a core count given as "n", "n:mesi" or "n:moesi".
+ * @param spec Core specification from the command line
+ * @param opt Options to store the cores and protocol in
+ * @return 0 on success, -1 on a malformed specification
+ */
+int parse_cores(char* spec, options_t* opt) {
+
+    char name[16] = "mesi";
+
+    if (sscanf(spec, "%d:%15s", &opt->cores, name) < 1 || opt->cores < 1 || opt->cores > MAX_CORES) {
+        fprintf(stderr, "Malformed core count %s (expected 1..%d[:mesi|moesi])\n", spec, MAX_CORES);
+        return -1;
+    }
+
+    if (strcmp(name, "mesi") == 0) {
+        opt->protocol = PROTOCOL_MESI;
+    } else if (strcmp(name, "moesi") == 0) {
+        opt->protocol = PROTOCOL_MOESI;
+    } else {
+        fprintf(stderr, "Unknown coherence protocol %s\n", name);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Replays a trace on coherent per-core caches and reports the traffic.
+ *
+ * Every core gets a private write-back cache with the -s/-t/-b/-E geometry.
+ *
+ * @param opt Command line options
+ * @param mem Pointer to the simulated main memory
+ * @param mask Address mask of the simulated main memory
+ * @param trace Trace handle
+ * @param elapsed Set to the replay time in seconds
+ * @return Number of accesses replayed
+ */
+unsigned long run_batch_smp(options_t* opt, uchar* mem, long mask, trace_t* trace, double* elapsed) {
+
+    smp_t* smp = create_smp(opt->cores, opt->s, opt->t, opt->b, opt->E, opt->policy, opt->protocol);
+
+    double begin = now_seconds();
+    unsigned long accesses = run_trace_smp(smp, mem, mask, trace);
+    *elapsed = now_seconds() - begin;
+
+    if (opt->verbose) {
+        for (int i = 0; i < smp->cores; i++) {
+            printf("Core %d\n", i);
+            print_cache(smp->core[i]);
+        }
+        puts("");
+    }
+
+    print_smp_summary(stdout, smp);
+
+    FILE* out;
+    if (opt->csv_path && (out = open_output(opt->csv_path)) != NULL) {
+        fprintf(out, "core,set,hits,misses,evictions,miss_rate\n");
+        for (int i = 0; i < smp->cores; i++) {
+            char prefix[16];
+            snprintf(prefix, sizeof(prefix), "%d,", i);
+            print_stats_csv_rows(out, smp->core[i], prefix);
+        }
+        close_output(out);
+    }
+
+    return accesses;
+}
+
+/**
+ * @brief Builds LRU miss-ratio curves for every geometry up to -s/-E in one pass.
+ * @param opt Command line options
+ * @param mask Address mask of the simulated main memory
+ * @param trace Trace handle
+ * @param elapsed Set to the replay time in seconds
+ * @return Number of accesses replayed, or 0 if the output cannot be opened
+ */
+unsigned long run_batch_mrc(options_t* opt, long mask, trace_t* trace, double* elapsed) {
+
+    FILE* out = open_output(opt->mrc_path);
+    if (out == NULL) {
+        return 0;
+    }
+
+    mrc_t* mrc = create_mrc(opt->s, opt->b, opt->E, opt->sample_rate);
+
+    double begin = now_seconds();
+    unsigned long accesses = run_trace_mrc(mrc, mask, trace);
+    *elapsed = now_seconds() - begin;
+
+    print_mrc_csv(out, mrc);
+    close_output(out);
+
+    printf("Curves   : %d set counts x %d ways, %lu of %lu accesses sampled at %d sets\n",
+        opt->s + 1, opt->E, mrc->sampled[opt->s], mrc->accesses, 1 << opt->s);
+
+    free_mrc(mrc);
+    return accesses;
+}
+
+/**
+ * @brief Replays a trace through a multi-level hierarchy and reports every level.
+ *
+ * L1 is the cache given by -s/-E/-p; lower levels come from -L. All levels
+ * share the block size and the s + t + b address width.
+ *
+ * @param opt Command line options
+ * @param mem Pointer to the simulated main memory
+ * @param mask Address mask of the simulated main memory
+ * @param trace Trace handle
+ * @param elapsed Set to the replay time in seconds
+ * @return Number of accesses replayed, or 0 on error
+ */
+unsigned long run_batch_hierarchy(options_t* opt, uchar* mem, long mask, trace_t* trace, double* elapsed) {
+
+    int m = opt->s + opt->t + opt->b;
+    cache_t levels[MAX_LEVELS];
+
+    levels[0] = initialize_cache_policy(opt->s, opt->t, opt->b, opt->E, opt->policy);
+
+    for (int i = 1; i < opt->num_levels; i++) {
+        int t = m - opt->level_s[i] - opt->b;
+        if (t < 0) {
+            fprintf(stderr, "Level L%d has more set bits than the address width allows\n", i + 1);
+            return 0;
+        }
+        levels[i] = initialize_cache_policy(opt->level_s[i], t, opt->b, opt->level_E[i],
+            opt->level_policy[i]);
+    }
+
+    for (int i = 0; i < opt->num_levels; i++) {
+        levels[i].write_policy = opt->write_policy;
+    }
+
+    hierarchy_t h = create_hierarchy(levels, opt->num_levels, opt->mode);
+
+    double begin = now_seconds();
+    unsigned long accesses = run_trace_hierarchy(&h, mem, mask, trace);
+    *elapsed = now_seconds() - begin;
+
+    if (opt->verbose) {
+        for (int i = 0; i < h.levels; i++) {
+            printf("L%d\n", i + 1);
+            print_cache(h.level[i]);
+        }
+        puts("");
+    }
+
+    print_hierarchy_summary(stdout, &h);
+
+    FILE* out;
+    if (opt->json_path && (out = open_output(opt->json_path)) != NULL) {
+        print_hierarchy_json(out, &h);
+        close_output(out);
+    }
+    if (opt->csv_path && (out = open_output(opt->csv_path)) != NULL) {
+        print_hierarchy_csv(out, &h);
+        close_output(out);
+    }
+
+    return accesses;
+}
+
+/**
+ * @brief Batch mode: replays a memory-mapped trace file through the cache.
+ *
+ * Main memory spans the whole simulated address space (2^(s+t+b) bytes). It is
+ * reserved lazily, so only the pages the trace actually touches are backed.
+ * Reports the number of accesses, the replay rate and the hit/miss statistics
+ * at the end.
+ *
+ * @param opt Command line options
+ * @return Exit status
+ */
+int run_batch(options_t* opt) {
+
+    int m = opt->s + opt->t + opt->b; // Simulated address width
+    if (m > MAX_ADDRESS_BITS) {
+        fprintf(stderr, "s + t + b must not exceed %d bits\n", MAX_ADDRESS_BITS);
+        return 1;
+    }
+
+    size_t mem_size = 1UL << m;
+    uchar* mem = mmap(NULL, mem_size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mem == MAP_FAILED) {
+        perror("mmap memory failed");
+        return 1;
+    }
+
+    trace_t trace;
+    if (open_trace(opt->path, opt->format, &trace) == -1) {
+        munmap(mem, mem_size);
+        return 1;
+    }
+
+    unsigned long accesses;
+    double begin, elapsed = 0;
+    int status = 0;
+
+    if (opt->mrc_path) {
+        accesses = run_batch_mrc(opt, (long)(mem_size - 1), &trace, &elapsed);
+        if (!accesses) {
+            status = 1;
+        }
+    } else if (opt->cores) {
+        accesses = run_batch_smp(opt, mem, (long)(mem_size - 1), &trace, &elapsed);
+    } else if (opt->num_levels > 1) {
+        accesses = run_batch_hierarchy(opt, mem, (long)(mem_size - 1), &trace, &elapsed);
+        if (!accesses) {
+            status = 1;
+        }
+    } else if (opt->soa) {
+        soa_cache_t cache = initialize_soa_cache(opt->s, opt->t, opt->b, opt->E);
+
+        begin = now_seconds();
+        accesses = run_trace_soa(cache, mem, (long)(mem_size - 1), &trace);
+        elapsed = now_seconds() - begin;
+
+        if (opt->verbose) {
+            print_soa_cache(cache);
+            puts("");
+        }
+        free_soa_cache(cache);
+    } else {
+        cache_t cache;
+
+        if (opt->restore_path) {
+            // Policies come from the checkpoint; -p and -W may only restate them
+            if (restore_cache(opt->restore_path, opt->s, opt->t, opt->b, opt->E, &cache) == -1) {
+                close_trace(&trace);
+                munmap(mem, mem_size);
+                return 1;
+            }
+            if ((opt->policy_given && cache.policy != opt->policy)
+                || (opt->write_given && cache.write_policy != opt->write_policy)) {
+                fprintf(stderr, "Checkpoint policies are -p %s -W %s\n", cache.policy->name,
+                    write_policy_name(cache.write_policy));
+                close_trace(&trace);
+                munmap(mem, mem_size);
+                return 1;
+            }
+        } else {
+            cache = initialize_cache_storage(opt->s, opt->t, opt->b, opt->E, opt->policy,
+                opt->metadata_only);
+            cache.write_policy = opt->write_policy;
+        }
+        if (opt->prefetcher) {
+            cache.prefetch = create_prefetch_state(opt->prefetcher, (long)(mem_size - 1));
+        }
+        if (opt->victim_entries) {
+            cache.victim = create_victim_cache(opt->victim_entries, opt->victim_mode);
+        }
+        if (opt->tlb_entries) {
+            cache.tlb = create_tlb(opt->tlb_entries, opt->tlb_ways, opt->page_bits, opt->index_mode, m);
+        }
+
+        begin = now_seconds();
+        if (opt->workers) {
+            accesses = run_trace_parallel(cache, mem, (long)(mem_size - 1), &trace, opt->workers);
+        } else {
+            accesses = run_trace(cache, mem, (long)(mem_size - 1), &trace);
+        }
+        elapsed = now_seconds() - begin;
+
+        if (opt->verbose) {
+            print_cache(cache);
+            puts("");
+        }
+
+        print_stats_summary(stdout, cache);
+
+        FILE* out;
+        if (opt->json_path && (out = open_output(opt->json_path)) != NULL) {
+            print_stats_json(out, cache);
+            close_output(out);
+        }
+        if (opt->csv_path && (out = open_output(opt->csv_path)) != NULL) {
+            print_stats_csv(out, cache);
+            close_output(out);
+        }
+        if (opt->save_path) {
+            if (save_cache(opt->save_path, cache) == -1) {
+                status = 1;
+            } else {
+                printf("Saved    : %s\n", opt->save_path);
+            }
+        }
+    }
+
+    printf("Accesses : %lu\n", accesses);
+    printf("Time     : %.3f s\n", elapsed);
+    printf("Rate     : %.0f accesses/sec\n", elapsed > 0 ? accesses / elapsed : 0.0);
+
+    close_trace(&trace);
+    munmap(mem, mem_size);
+    return status;
+}
+
+/**
+ * @brief Main function: runs the interactive simulator, or replays a trace
+ *        when a trace file is given on the command line.
+ */
+int main(int argc, char* argv[]) {
+
+    if (argc == 1) {
+        return run_interactive();
+    }
+
+    options_t opt = {0};
+    int c;
+
+    opt.s = opt.t = opt.b = opt.E = -1;
+    opt.format = TRACE_BINARY;
+    opt.policy = &frequency_policy;
+    opt.num_levels = 1;
+    opt.mode = HIERARCHY_INCLUSIVE;
+    opt.sample_rate = 1.0;
+
+    while ((c = getopt(argc, argv, "s:t:b:E:f:lp:F:V:T:W:P:MSK:L:xC:j:c:m:R:r:k:vh")) != -1) {
+        switch (c)
+        {
+            case 's': opt.s = atoi(optarg); break;
+            case 't': opt.t = atoi(optarg); break;
+            case 'b': opt.b = atoi(optarg); break;
+            case 'E': opt.E = atoi(optarg); break;
+            case 'f': opt.path = optarg; break;
+            case 'l': opt.format = TRACE_LACKEY; break;
+            case 'p':
+                if ((opt.policy = find_policy(optarg)) == NULL) {
+                    fprintf(stderr, "Unknown replacement policy %s\n", optarg);
+                    return 1;
+                }
+                opt.policy_given = 1;
+                break;
+            case 'F':
+                if ((opt.prefetcher = find_prefetcher(optarg)) == NULL) {
+                    fprintf(stderr, "Unknown prefetcher %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'V':
+                if (parse_victim(optarg, &opt) == -1) {
+                    return 1;
+                }
+                break;
+            case 'T':
+                if (parse_tlb(optarg, &opt) == -1) {
+                    return 1;
+                }
+                break;
+            case 'W':
+                if ((opt.write_policy = parse_write_policy(optarg)) == -1) {
+                    fprintf(stderr, "Unknown write policy %s\n", optarg);
+                    return 1;
+                }
+                opt.write_given = 1;
+                break;
+            case 'P': opt.workers = atoi(optarg); break;
+            case 'M': opt.metadata_only = 1; break;
+            case 'S': opt.soa = 1; break;
+            case 'K': opt.kernel = optarg; break;
+            case 'L':
+                if (parse_level(optarg, &opt) == -1) {
+                    return 1;
+                }
+                break;
+            case 'x': opt.mode = HIERARCHY_EXCLUSIVE; break;
+            case 'C':
+                if (parse_cores(optarg, &opt) == -1) {
+                    return 1;
+                }
+                break;
+            case 'j': opt.json_path = optarg; break;
+            case 'c': opt.csv_path = optarg; break;
+            case 'm': opt.mrc_path = optarg; break;
+            case 'R':
+                opt.sample_rate = atof(optarg);
+                opt.rate_given = 1;
+                break;
+            case 'r': opt.restore_path = optarg; break;
+            case 'k': opt.save_path = optarg; break;
+            case 'v': opt.verbose = 1; break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (opt.s < 0 || opt.t < 0 || opt.b < 0 || opt.E < 1 || opt.E > 255 || !opt.path
+        || (opt.soa && (opt.num_levels > 1 || opt.write_policy || opt.policy != &frequency_policy
+            || opt.json_path || opt.csv_path))
+        || opt.workers < 0 || opt.workers > MAX_WORKERS
+        || (opt.workers && (opt.soa || opt.num_levels > 1))
+        || opt.sample_rate <= 0 || opt.sample_rate > 1
+        || (opt.kernel && !opt.soa)
+        || (opt.rate_given && !opt.mrc_path)
+        || (opt.mode == HIERARCHY_EXCLUSIVE && opt.num_levels == 1)
+        || (opt.mrc_path && (opt.soa || opt.workers || opt.num_levels > 1 || opt.cores || opt.prefetcher))
+        || (opt.metadata_only && (opt.soa || opt.num_levels > 1 || opt.cores))
+        || ((opt.save_path || opt.restore_path) && (opt.soa || opt.num_levels > 1 || opt.cores || opt.mrc_path))
+        || (opt.restore_path && opt.metadata_only)
+        || (opt.tlb_entries && (opt.soa || opt.workers || opt.num_levels > 1 || opt.cores || opt.mrc_path
+            || opt.s + opt.t + opt.b < opt.page_bits))
+        || (opt.victim_entries && (opt.soa || opt.workers || opt.num_levels > 1 || opt.cores || opt.mrc_path))
+        || (opt.prefetcher && (opt.soa || opt.workers || opt.num_levels > 1 || opt.cores))
+        || (opt.cores && (opt.soa || opt.workers || opt.num_levels > 1 || opt.write_policy || opt.json_path))) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (opt.kernel && parse_tag_kernel(opt.kernel) == -1) {
+        fprintf(stderr, "Kernel %s is not supported on this CPU\n", opt.kernel);
+        return 1;
+    }
+
+    return run_batch(&opt);
+}
@@ -0,0 +1,130 @@
+#include "mrc.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Mixes a block number into a well-distributed 64-bit hash.
+ */
+static unsigned long hash_block(long block) {
+    unsigned long x = (unsigned long)block * 0x9E3779B97F4A7C15UL;
+    x ^= x >> 29;
+    x *= 0xBF58476D1CE4E5B9UL;
+    return x ^ (x >> 32);
+}
+
+/**
+ * @brief Allocates the state of a miss-ratio curve.
+ * @param s Set bits of the largest geometry (curves cover 2^0 .. 2^s sets)
+ * @param b Number of block offset bits
+ * @param E Largest associativity of the curve
+ * @param rate SHARDS sampling rate in (0, 1], 1 for exact curves
+ * @return Empty curve state
+ */
+mrc_t* create_mrc(uchar s, uchar b, uchar E, double rate) {
+
+    mrc_t* mrc = calloc(1, sizeof(mrc_t));
+    size_t stack_words = (((size_t)2 << s) - 1) * E;
+
+    mrc->s = s;
+    mrc->b = b;
+    mrc->E = E;
+    mrc->rate = rate;
+    mrc->threshold = (unsigned long)(rate * (1UL << MRC_SAMPLE_BITS));
+    mrc->hist = calloc((size_t)(s + 1) * E, sizeof(unsigned long));
+    mrc->sampled = calloc(s + 1, sizeof(unsigned long));
+
+    // Level l owns the 2^l stacks starting at stack 2^l - 1
+    mrc->stacks = malloc(sizeof(long) * stack_words);
+    memset(mrc->stacks, 0xff, sizeof(long) * stack_words);
+
+    return mrc;
+}
+
+/**
+ * @brief Moves a block to the top of an LRU stack.
+ * @param stack Stack of E blocks, most recent first
+ * @param E Depth of the stack
+ * @param block Block number
+ * @return Previous position of the block (its stack distance), -1 if it was not in the stack
+ */
+static int push_block(long* stack, int E, long block) {
+
+    int i = 0;
+    while (i < E && stack[i] != block && stack[i] != -1) i++;
+
+    int distance = (i < E && stack[i] == block) ? i : -1;
+
+    // Shift the more recent blocks down; a block past the bottom falls out
+    if (i == E) i--;
+    memmove(stack + 1, stack, sizeof(long) * i);
+    stack[0] = block;
+
+    return distance;
+}
+
+/**
+ * @brief Feeds one access to the curve.
+ *
+ * Reads and writes are treated alike, as in a write-allocate LRU cache.
+ *
+ * @param mrc Curve state
+ * @param addr Accessed address
+ */
+void mrc_access(mrc_t* mrc, long addr) {
+
+    long block = addr >> mrc->b;
+
+    mrc->accesses++;
+
+    for (int level = 0; level <= mrc->s; level++) {
+        long set = block & ((1L << level) - 1);
+
+        // Sample sets once there are enough of them to pick a fraction
+        if ((double)(1L << level) * mrc->rate >= 1
+            && (hash_block(set) & ((1UL << MRC_SAMPLE_BITS) - 1)) >= mrc->threshold) {
+            continue;
+        }
+
+        long* stack = mrc->stacks + ((1L << level) - 1 + set) * mrc->E;
+        int distance = push_block(stack, mrc->E, block);
+
+        mrc->sampled[level]++;
+        if (distance >= 0) {
+            mrc->hist[(size_t)level * mrc->E + distance]++;
+        }
+    }
+}
+
+/**
+ * @brief Writes the miss ratio of every (sets, ways) geometry as CSV.
+ *
+ * One row per geometry: s, E, cache size in bytes and the LRU miss ratio.
+ *
+ * @param out Output stream
+ * @param mrc Curve state
+ */
+void print_mrc_csv(FILE* out, mrc_t* mrc) {
+
+    fprintf(out, "s,E,size_bytes,miss_ratio\n");
+
+    for (int level = 0; level <= mrc->s; level++) {
+        unsigned long hits = 0;
+
+        for (int E = 1; E <= mrc->E; E++) {
+            hits += mrc->hist[(size_t)level * mrc->E + E - 1];
+            fprintf(out, "%d,%d,%lu,%.6f\n", level, E, ((unsigned long)E << level) << mrc->b,
+                mrc->sampled[level] ? 1.0 - (double)hits / mrc->sampled[level] : 0.0);
+        }
+    }
+}
+
+/**
+ * @brief Releases a curve state.
+ * @param mrc Curve state
+ */
+void free_mrc(mrc_t* mrc) {
+    free(mrc->hist);
+    free(mrc->sampled);
+    free(mrc->stacks);
+    free(mrc);
+}
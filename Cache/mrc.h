@@ -0,0 +1,40 @@
+#ifndef MRC_H
+#define MRC_H
+
+#include <stdio.h>
+#include "cache.h"
+
+#define MRC_SAMPLE_BITS 24 // Precision of the SHARDS sampling threshold
+
+/*
+ * Single-pass miss-ratio curves (Mattson stack distances).
+ *
+ * LRU has the inclusion property: a set with E ways holds exactly the E most
+ * recently used blocks mapping to it. So one LRU stack per set, truncated at
+ * the largest associativity, gives the stack distance of every access, and
+ * an access hits in every geometry with more ways than its distance. Keeping
+ * stacks for every set count 2^0 .. 2^s yields the miss ratio of each
+ * (sets, ways) geometry up to (2^s, E) in one pass.
+ *
+ * Sampling follows SHARDS, but selects sets rather than blocks: a set is
+ * tracked if the hash of its index falls under rate * 2^MRC_SAMPLE_BITS.
+ * Every tracked set sees all of its accesses, so its distances are exact
+ * and need no scaling (scaled block-sampled distances are too coarse for
+ * small E). Set counts too small to sample from are tracked in full.
+ */
+typedef struct mrc_s {
+    uchar s, b, E;              // Largest geometry of the curve
+    double rate;                // SHARDS sampling rate, 1 = exact
+    unsigned long threshold;    // Sampled if hash < threshold
+    unsigned long accesses;     // All accesses seen
+    unsigned long* sampled;     // Accesses to tracked sets, per set count
+    unsigned long* hist;        // (s + 1) * E stack distance counters
+    long* stacks;               // 2^(s+1) - 1 sets of E blocks, most recent first, -1 = empty
+} mrc_t;
+
+mrc_t* create_mrc(uchar s, uchar b, uchar E, double rate);
+void mrc_access(mrc_t* mrc, long addr);
+void print_mrc_csv(FILE* out, mrc_t* mrc);
+void free_mrc(mrc_t* mrc);
+
+#endif
@@ -0,0 +1,155 @@
+#include "parallel.h"
+#include "stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+
+typedef struct worker_s {
+    spsc_queue_t queue;
+    _Alignas(64) size_t tail; // Producer side: next slot to fill (not yet published)
+    size_t cached_head;       // Producer side: last head read from the queue
+    pthread_t thread;
+    cache_t cache;            // Shares the sets, owns its statistics
+    uchar* mem;
+} worker_t;
+
+/**
+ * @brief Worker loop: replays every access of its queue until the producer is done.
+ *
+ * A worker only ever sees addresses of the sets it owns, so the lines,
+ * replacement state and memory blocks it touches are private to it.
+ */
+static void* worker_main(void* arg) {
+
+    worker_t* w = arg;
+    spsc_queue_t* q = &w->queue;
+    size_t head = 0;
+
+    while (1) {
+        size_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+
+        if (head == tail) {
+            // Exit only once nothing more can be published
+            if (atomic_load_explicit(&q->done, memory_order_acquire)
+                && head == atomic_load_explicit(&q->tail, memory_order_acquire)) {
+                break;
+            }
+            sched_yield();
+            continue;
+        }
+
+        for (; head != tail; head++) {
+            trace_access_t* a = &q->items[head & (QUEUE_CAPACITY - 1)];
+            if (a->write) {
+                write_byte(w->cache, w->mem, a->addr, w->mem[a->addr]);
+            } else {
+                read_byte(w->cache, w->mem, a->addr);
+            }
+        }
+
+        atomic_store_explicit(&q->head, head, memory_order_release);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Appends one access to a worker's queue, waiting while it is full.
+ *
+ * The head is only re-read when the producer's cached copy says the queue
+ * is full, so the fast path touches no shared cache line.
+ *
+ * @param w The worker owning the queue
+ * @param access The access to append
+ */
+static void queue_push(worker_t* w, trace_access_t access) {
+
+    spsc_queue_t* q = &w->queue;
+
+    if (w->tail - w->cached_head == QUEUE_CAPACITY) {
+        // Publish what we have and wait for the worker to make room
+        atomic_store_explicit(&q->tail, w->tail, memory_order_release);
+        while ((w->cached_head = atomic_load_explicit(&q->head, memory_order_acquire))
+            + QUEUE_CAPACITY == w->tail) {
+            sched_yield();
+        }
+    }
+
+    q->items[w->tail & (QUEUE_CAPACITY - 1)] = access;
+    w->tail++;
+}
+
+/**
+ * @brief Replays a whole trace with the sets partitioned across worker threads.
+ *
+ * The calling thread decodes the trace and routes each access to the worker
+ * owning its set (set_index % workers) through that worker's lock-free
+ * queue. Each worker keeps its own statistics; they are merged into
+ * cache.stats at the end. Since every set sees its accesses in trace order
+ * and no state is shared between sets, the final cache contents and
+ * statistics are identical to run_trace.
+ *
+ * @param cache The cache structure (single level)
+ * @param mem Pointer to the simulated main memory
+ * @param mask Address mask of the simulated main memory
+ * @param trace Trace handle positioned at the first record
+ * @param workers Number of worker threads (1 .. MAX_WORKERS)
+ * @return Number of accesses replayed
+ */
+unsigned long run_trace_parallel(cache_t cache, uchar* mem, long mask, trace_t* trace, int workers) {
+
+    static trace_access_t batch[TRACE_BATCH];
+    worker_t* pool = aligned_alloc(64, sizeof(worker_t) * workers);
+    unsigned long total = 0;
+    size_t n;
+
+    for (int i = 0; i < workers; i++) {
+        worker_t* w = &pool[i];
+
+        w->queue.items = malloc(sizeof(trace_access_t) * QUEUE_CAPACITY);
+        atomic_init(&w->queue.head, 0);
+        atomic_init(&w->queue.tail, 0);
+        atomic_init(&w->queue.done, 0);
+        w->tail = w->cached_head = 0;
+
+        w->cache = cache;
+        w->cache.stats = create_stats(cache.s);
+        w->mem = mem;
+
+        if (pthread_create(&w->thread, NULL, worker_main, w) != 0) {
+            perror("pthread_create failed");
+            exit(1);
+        }
+    }
+
+    while ((n = next_trace_batch(trace, batch, TRACE_BATCH)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            trace_access_t a = batch[i];
+            a.addr &= mask;
+
+            int owner = ((a.addr >> cache.b) & cache.set_mask) % workers;
+            queue_push(&pool[owner], a);
+        }
+
+        // Publish the block to every worker at once
+        for (int i = 0; i < workers; i++) {
+            atomic_store_explicit(&pool[i].queue.tail, pool[i].tail, memory_order_release);
+        }
+        total += n;
+    }
+
+    for (int i = 0; i < workers; i++) {
+        atomic_store_explicit(&pool[i].queue.done, 1, memory_order_release);
+    }
+
+    for (int i = 0; i < workers; i++) {
+        pthread_join(pool[i].thread, NULL);
+        merge_stats(cache.stats, pool[i].cache.stats);
+        free_stats(pool[i].cache.stats);
+        free(pool[i].queue.items);
+    }
+
+    free(pool);
+    return total;
+}
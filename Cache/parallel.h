@@ -0,0 +1,26 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stdatomic.h>
+#include "cache.h"
+#include "trace.h"
+
+#define MAX_WORKERS 64
+#define QUEUE_CAPACITY (1 << 16) // Accesses per worker queue (power of two)
+
+/*
+ * Single-producer, single-consumer ring buffer of accesses.
+ *
+ * The producer owns tail and the consumer owns head; each index sits on its
+ * own host cache line so the two threads do not false-share.
+ */
+typedef struct spsc_queue_s {
+    trace_access_t* items;
+    _Alignas(64) atomic_size_t head; // Next slot to consume
+    _Alignas(64) atomic_size_t tail; // Next slot to produce
+    _Alignas(64) atomic_int done;    // Set once the producer has published everything
+} spsc_queue_t;
+
+unsigned long run_trace_parallel(cache_t cache, uchar* mem, long mask, trace_t* trace, int workers);
+
+#endif
@@ -0,0 +1,269 @@
+#include "policy.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Returns the first line of a full set with the smallest frequency.
+ */
+static int min_frequency_line(cache_line_t* set, int E) {
+    int victim = 0;
+    for (int i = 1; i < E; i++) {
+        if (set[i].frequency < set[victim].frequency) {
+            victim = i;
+        }
+    }
+    return victim;
+}
+
+/**
+ * @brief Returns the first line of a full set with the smallest age.
+ */
+static int min_age_line(cache_line_t* set, int E) {
+    int victim = 0;
+    for (int i = 1; i < E; i++) {
+        if (set[i].age < set[victim].age) {
+            victim = i;
+        }
+    }
+    return victim;
+}
+
+/**
+ * @brief Advances the xorshift64 generator of a set.
+ */
+static unsigned long next_random(repl_set_t* set) {
+    unsigned long x = set->rng;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return set->rng = x;
+}
+
+/**
+ * @brief Policy hook that keeps no state.
+ */
+static void no_update(cache_t* cache, long set_index, int line) {}
+
+/* Frequency: the original policy, 8-bit counter that wraps */
+
+/**
+ * @brief Counts a hit; the 8-bit counter wraps around like the original simulator.
+ */
+static void frequency_hit(cache_t* cache, long set_index, int line) {
+    cache->cache[set_index][line].frequency += 1;
+}
+
+/**
+ * @brief Evicts the first least frequently used line.
+ */
+static int frequency_victim(cache_t* cache, long set_index) {
+    return min_frequency_line(cache->cache[set_index], cache->E);
+}
+
+const repl_policy_t frequency_policy = {"frequency", no_update, frequency_hit, frequency_victim};
+
+/* LFU: saturating 8-bit counter */
+
+/**
+ * @brief Counts a hit, saturating at 255 instead of wrapping.
+ */
+static void lfu_hit(cache_t* cache, long set_index, int line) {
+    cache_line_t* l = &cache->cache[set_index][line];
+    if (l->frequency < 255) {
+        l->frequency += 1;
+    }
+}
+
+const repl_policy_t lfu_policy = {"lfu", no_update, lfu_hit, frequency_victim};
+
+/* LRU and FIFO: stamp lines with the access clock */
+
+/**
+ * @brief Stamps a line with the current access clock of its set.
+ */
+static void stamp_line(cache_t* cache, long set_index, int line) {
+    cache->cache[set_index][line].age = ++cache->repl->sets[set_index].clock;
+}
+
+/**
+ * @brief Evicts the line with the oldest stamp.
+ */
+static int age_victim(cache_t* cache, long set_index) {
+    return min_age_line(cache->cache[set_index], cache->E);
+}
+
+const repl_policy_t lru_policy = {"lru", stamp_line, stamp_line, age_victim};
+const repl_policy_t fifo_policy = {"fifo", stamp_line, no_update, age_victim};
+
+/* Random */
+
+/**
+ * @brief Evicts a uniformly random line.
+ */
+static int random_victim(cache_t* cache, long set_index) {
+    return next_random(&cache->repl->sets[set_index]) % cache->E;
+}
+
+const repl_policy_t random_policy = {"random", no_update, no_update, random_victim};
+
+/* Tree-PLRU */
+
+/*
+ * Node n of the binary tree (root 1, children 2n and 2n + 1) covers a
+ * power-of-two range of ways. Its bit is 1 when the next victim should come
+ * from the right half. When E is not a power of two, halves that start past
+ * the last way are never chosen.
+ */
+
+/**
+ * @brief Points the tree away from the accessed line.
+ */
+static void plru_touch(cache_t* cache, long set_index, int line) {
+    repl_state_t* repl = cache->repl;
+    unsigned long* bits = repl->tree + set_index * repl->tree_words;
+    int span = repl->tree_span;
+    int node = 1, lo = 0;
+
+    while (span > 1) {
+        span >>= 1;
+        if (line < lo + span) {
+            bits[node / 64] |= 1UL << (node % 64);     // Accessed left, evict right
+            node = 2 * node;
+        } else {
+            bits[node / 64] &= ~(1UL << (node % 64));  // Accessed right, evict left
+            node = 2 * node + 1;
+            lo += span;
+        }
+    }
+}
+
+/**
+ * @brief Follows the tree bits down to the pseudo least recently used line.
+ */
+static int plru_victim(cache_t* cache, long set_index) {
+    repl_state_t* repl = cache->repl;
+    unsigned long* bits = repl->tree + set_index * repl->tree_words;
+    int span = repl->tree_span;
+    int node = 1, lo = 0;
+
+    while (span > 1) {
+        span >>= 1;
+        int right = (bits[node / 64] >> (node % 64)) & 1;
+        if (right && lo + span < cache->E) {
+            node = 2 * node + 1;
+            lo += span;
+        } else {
+            node = 2 * node;
+        }
+    }
+    return lo;
+}
+
+const repl_policy_t plru_policy = {"plru", plru_touch, plru_touch, plru_victim};
+
+/* SRRIP / BRRIP: 2-bit re-reference prediction in age */
+
+/**
+ * @brief Predicts a near-immediate re-reference for a line that hit.
+ */
+static void rrip_hit(cache_t* cache, long set_index, int line) {
+    cache->cache[set_index][line].age = 0;
+}
+
+/**
+ * @brief Inserts a line with a long re-reference prediction.
+ */
+static void srrip_fill(cache_t* cache, long set_index, int line) {
+    cache->cache[set_index][line].age = RRPV_MAX - 1;
+}
+
+/**
+ * @brief Inserts most lines with a distant re-reference prediction, so scans
+ *        do not flush the set, and one in BRRIP_THROTTLE with a long one.
+ */
+static void brrip_fill(cache_t* cache, long set_index, int line) {
+    int rare = (++cache->repl->sets[set_index].fills % BRRIP_THROTTLE) == 0;
+    cache->cache[set_index][line].age = rare ? RRPV_MAX - 1 : RRPV_MAX;
+}
+
+/**
+ * @brief Evicts the first line predicted to be re-referenced in the distant future.
+ */
+static int rrip_victim(cache_t* cache, long set_index) {
+    cache_line_t* set = cache->cache[set_index];
+    int E = cache->E;
+
+    // Age the whole set until some line reaches the distant prediction
+    while (1) {
+        for (int i = 0; i < E; i++) {
+            if (set[i].age >= RRPV_MAX) {
+                return i;
+            }
+        }
+        for (int i = 0; i < E; i++) {
+            set[i].age += 1;
+        }
+    }
+}
+
+const repl_policy_t srrip_policy = {"srrip", srrip_fill, rrip_hit, rrip_victim};
+const repl_policy_t brrip_policy = {"brrip", brrip_fill, rrip_hit, rrip_victim};
+
+/* Registry */
+
+static const repl_policy_t* policies[] = {
+    &frequency_policy, &lfu_policy, &lru_policy, &plru_policy,
+    &fifo_policy, &random_policy, &srrip_policy, &brrip_policy
+};
+
+#define NUM_POLICIES (sizeof(policies) / sizeof(policies[0]))
+
+/**
+ * @brief Looks up a replacement policy by name.
+ * @param name Policy name (e.g. "lru")
+ * @return The policy, or NULL if there is none by that name
+ */
+const repl_policy_t* find_policy(const char* name) {
+    for (size_t i = 0; i < NUM_POLICIES; i++) {
+        if (strcmp(policies[i]->name, name) == 0) {
+            return policies[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Prints the names of all replacement policies.
+ * @param out Output stream
+ */
+void list_policies(FILE* out) {
+    for (size_t i = 0; i < NUM_POLICIES; i++) {
+        fprintf(out, "%s%s", i ? ", " : "", policies[i]->name);
+    }
+}
+
+/**
+ * @brief Allocates the replacement state shared by all policies.
+ * @param s Number of set index bits
+ * @param E Number of lines per set
+ * @return Zeroed policy state with every set's random generator seeded
+ */
+repl_state_t* create_repl_state(uchar s, uchar E) {
+
+    repl_state_t* repl = calloc(1, sizeof(repl_state_t));
+
+    // One tree bit per internal node of a power-of-two tree covering E ways
+    repl->tree_span = 1;
+    while (repl->tree_span < E) repl->tree_span <<= 1;
+
+    repl->tree_words = (repl->tree_span + 63) / 64;
+    repl->tree = calloc((size_t)repl->tree_words << s, sizeof(unsigned long));
+
+    // Distinct, reproducible random streams per set
+    repl->sets = calloc(1UL << s, sizeof(repl_set_t));
+    for (long i = 0; i < (1L << s); i++) {
+        repl->sets[i].rng = POLICY_SEED ^ ((unsigned long)(i + 1) * 0x9E3779B97F4A7C15UL);
+    }
+
+    return repl;
+}
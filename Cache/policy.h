@@ -0,0 +1,53 @@
+#ifndef POLICY_H
+#define POLICY_H
+
+#include <stdio.h>
+#include "cache.h"
+
+#define RRPV_MAX 3        // 2-bit re-reference prediction values (SRRIP/BRRIP)
+#define BRRIP_THROTTLE 32 // BRRIP inserts one in every BRRIP_THROTTLE fills at RRPV_MAX - 1
+#define POLICY_SEED 0x2545F4914F6CDD1DUL // Fixed seed so the random policy is reproducible
+
+/*
+ * Replacement policy interface.
+ *
+ * on_fill runs after a line has been filled (cold or conflict miss), on_hit
+ * after a read or write hit, and victim picks the line to evict from a full
+ * set. Per-line policy state lives in cache_line_t.frequency and
+ * cache_line_t.age; per-set state lives in cache->repl. No state is shared
+ * between sets, so sets can be simulated independently (see parallel.c).
+ */
+struct repl_policy_s {
+    const char* name;
+    void (*on_fill)(cache_t* cache, long set_index, int line);
+    void (*on_hit)(cache_t* cache, long set_index, int line);
+    int (*victim)(cache_t* cache, long set_index);
+};
+
+typedef struct repl_set_s {
+    unsigned long clock;   // Access counter for LRU/FIFO stamps
+    unsigned long rng;     // xorshift64 state for random victims
+    unsigned long fills;   // Fill counter for the BRRIP throttle
+} repl_set_t;
+
+struct repl_state_s {
+    repl_set_t* sets;      // Per-set counters
+    int tree_span;         // Smallest power of two >= E
+    int tree_words;        // Words of tree-PLRU bits per set
+    unsigned long* tree;   // Tree-PLRU bits, tree_words per set
+};
+
+extern const repl_policy_t frequency_policy;
+extern const repl_policy_t lfu_policy;
+extern const repl_policy_t lru_policy;
+extern const repl_policy_t plru_policy;
+extern const repl_policy_t fifo_policy;
+extern const repl_policy_t random_policy;
+extern const repl_policy_t srrip_policy;
+extern const repl_policy_t brrip_policy;
+
+const repl_policy_t* find_policy(const char* name);
+void list_policies(FILE* out);
+repl_state_t* create_repl_state(uchar s, uchar E);
+
+#endif
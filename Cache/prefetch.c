@@ -0,0 +1,332 @@
+#include "prefetch.h"
+#include "stats.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Returns the pollution filter slot of a block address.
+ */
+static long* filter_slot(cache_t* cache, long block) {
+    return &cache->prefetch->filter[(block >> cache->b) & (POLLUTION_FILTER - 1)];
+}
+
+/**
+ * @brief Installs a block on behalf of the prefetcher.
+ *
+ * Blocks that are already cached are skipped. The line is tagged as
+ * prefetched until a demand access uses it, and the block it replaced is
+ * remembered so a later demand miss on it counts as pollution.
+ *
+ * @param cache The cache structure (by value)
+ * @param start Pointer to the start of main memory
+ * @param off Any address inside the block to prefetch
+ * @return 1 if the block was fetched, 0 if it was already cached
+ */
+int prefetch_block(cache_t cache, uchar* start, long off) {
+
+    prefetch_state_t* pf = cache.prefetch;
+    long evicted;
+
+    off &= pf->mask;
+    if (find_line(cache, off) != NULL) {
+        return 0;
+    }
+
+    int line_index = install_block(cache, start, off, &evicted);
+    cache.cache[decode_address(cache, off).set_index][line_index].prefetched = 1;
+    pf->issued++;
+
+    if (evicted != -1) {
+        *filter_slot(&cache, evicted) = evicted;
+    }
+    return 1;
+}
+
+/**
+ * @brief Prefetcher hook that never supplies a block.
+ */
+static int no_lookup(cache_t* cache, uchar* start, long block) {
+    return 0;
+}
+
+/* Next-line: fetch block n + 1 on a miss or a first hit to a prefetched block */
+
+/**
+ * @brief Prefetches the next sequential block (tagged next-line prefetch).
+ */
+static void next_line_train(cache_t* cache, uchar* start, long off, int trigger) {
+    if (trigger) {
+        prefetch_block(*cache, start, (off | cache->offset_mask) + 1);
+    }
+}
+
+const prefetcher_t next_line_prefetcher = {"next-line", no_lookup, next_line_train};
+
+/* Stride: per-PC reference prediction table */
+
+/**
+ * @brief Learns the stride of the current PC and prefetches along it.
+ *
+ * Once the same non-zero stride has repeated STRIDE_CONFIDENT times, the
+ * block one stride ahead is fetched; strides shorter than a block fetch the
+ * neighbouring block in the stride's direction. Traces without PCs share a
+ * single entry, which still catches one global stream.
+ */
+static void stride_train(cache_t* cache, uchar* start, long off, int trigger) {
+
+    prefetch_state_t* pf = cache->prefetch;
+    stride_entry_t* e = &pf->stride[((unsigned long)pf->pc * 0x9E3779B97F4A7C15UL) >> 56];
+
+    if (e->pc != pf->pc) {
+        e->pc = pf->pc;
+        e->last = off;
+        e->stride = 0;
+        e->confidence = 0;
+        return;
+    }
+
+    long stride = off - e->last;
+    e->last = off;
+
+    if (stride == 0) {
+        return;
+    }
+
+    if (stride == e->stride) {
+        if (e->confidence < STRIDE_CONFIDENT) {
+            e->confidence++;
+        }
+    } else {
+        e->stride = stride;
+        e->confidence = 0;
+    }
+
+    if (e->confidence == STRIDE_CONFIDENT) {
+        long block = 1L << cache->b;
+        long step = stride;
+
+        if (labs(stride) < block) {
+            step = stride > 0 ? block : -block;
+        }
+        prefetch_block(*cache, start, off + step);
+    }
+}
+
+const prefetcher_t stride_prefetcher = {"stride", no_lookup, stride_train};
+
+/* Stream buffers: sequential blocks held outside the cache (Jouppi) */
+
+/**
+ * @brief Refills a stream buffer up to STREAM_DEPTH blocks.
+ *
+ * The blocks are read from memory now, so they count as block fills even
+ * if they are never used.
+ */
+static void fill_stream(cache_t* cache, stream_buffer_t* sb) {
+    cache->prefetch->issued += STREAM_DEPTH - sb->count;
+    cache->stats->block_fills += STREAM_DEPTH - sb->count;
+    sb->count = STREAM_DEPTH;
+}
+
+/**
+ * @brief Looks a missing block up in the stream buffers.
+ *
+ * On a match the block moves into the cache without another fill or a
+ * victim cache probe, the blocks before it are dropped and the buffer is
+ * topped up. Buffered blocks never displace cache lines, so stream buffers
+ * cannot pollute the cache.
+ */
+static int stream_lookup(cache_t* cache, uchar* start, long block) {
+
+    prefetch_state_t* pf = cache->prefetch;
+    long B = 1L << cache->b;
+
+    for (int i = 0; i < STREAM_BUFFERS; i++) {
+        stream_buffer_t* sb = &pf->streams[i];
+        long index = (block - sb->head) / B;
+
+        if (sb->count && block >= sb->head && index < sb->count) {
+            long evicted;
+            // Fetched (and counted) by fill_stream; memory still holds the data
+            place_block(*cache, start, block, start + block, 0, &evicted);
+            pf->useful++;
+
+            sb->head = (block + B) & pf->mask;
+            sb->count -= index + 1;
+            sb->stamp = ++pf->clock;
+            fill_stream(cache, sb);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Allocates the least recently used stream buffer on a miss.
+ */
+static void stream_train(cache_t* cache, uchar* start, long off, int trigger) {
+
+    prefetch_state_t* pf = cache->prefetch;
+
+    if (!trigger) {
+        return;
+    }
+
+    stream_buffer_t* lru = &pf->streams[0];
+    for (int i = 1; i < STREAM_BUFFERS; i++) {
+        if (pf->streams[i].stamp < lru->stamp) {
+            lru = &pf->streams[i];
+        }
+    }
+
+    lru->head = ((off | cache->offset_mask) + 1) & pf->mask;
+    lru->count = 0;
+    lru->stamp = ++pf->clock;
+    fill_stream(cache, lru);
+}
+
+const prefetcher_t stream_prefetcher = {"stream", stream_lookup, stream_train};
+
+static const prefetcher_t* prefetchers[] = {
+    &next_line_prefetcher, &stride_prefetcher, &stream_prefetcher
+};
+
+#define NUM_PREFETCHERS (sizeof(prefetchers) / sizeof(prefetchers[0]))
+
+/**
+ * @brief Looks a prefetcher up by name.
+ * @param name Prefetcher name (next-line, stride, stream)
+ * @return The prefetcher, or NULL if the name is unknown
+ */
+const prefetcher_t* find_prefetcher(const char* name) {
+    for (size_t i = 0; i < NUM_PREFETCHERS; i++) {
+        if (strcmp(prefetchers[i]->name, name) == 0) {
+            return prefetchers[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Prints the names of all prefetchers.
+ * @param out Output stream
+ */
+void list_prefetchers(FILE* out) {
+    for (size_t i = 0; i < NUM_PREFETCHERS; i++) {
+        fprintf(out, "%s%s", i ? ", " : "", prefetchers[i]->name);
+    }
+}
+
+/**
+ * @brief Allocates the state of a prefetcher.
+ * @param prefetcher The prefetcher to run
+ * @param mask Address mask of main memory (prefetches never leave it)
+ * @return Zeroed prefetcher state
+ */
+prefetch_state_t* create_prefetch_state(const prefetcher_t* prefetcher, long mask) {
+
+    prefetch_state_t* pf = calloc(1, sizeof(prefetch_state_t));
+
+    pf->prefetcher = prefetcher;
+    pf->mask = mask;
+    for (int i = 0; i < POLLUTION_FILTER; i++) {
+        pf->filter[i] = -1;
+    }
+    for (int i = 0; i < STRIDE_TABLE; i++) {
+        pf->stride[i].pc = -1;
+    }
+
+    return pf;
+}
+
+/**
+ * @brief Runs in front of a demand access.
+ *
+ * If the block is not cached, counts pollution when a prefetch evicted it
+ * and lets the prefetcher supply it from its own buffers.
+ *
+ * @param cache The cache structure (by value)
+ * @param start Pointer to the start of main memory
+ * @param off The memory address offset accessed
+ */
+void prefetch_before(cache_t cache, uchar* start, long off) {
+
+    long block = off & ~cache.offset_mask;
+
+    if (find_line(cache, off) != NULL) {
+        return;
+    }
+
+    long* slot = filter_slot(&cache, block);
+    if (*slot == block) {
+        cache.prefetch->pollution++;
+        *slot = -1;
+    }
+
+    cache.prefetch->prefetcher->lookup(&cache, start, block);
+}
+
+/**
+ * @brief Runs after a demand access: credits used prefetches and trains
+ *        the prefetcher.
+ * @param cache The cache structure (by value)
+ * @param start Pointer to the start of main memory
+ * @param off The memory address offset accessed
+ * @param line Line holding the block, NULL if the access bypassed the cache
+ * @param status CACHE_HIT, COLD_MISS or CONFLICT_MISS
+ */
+void prefetch_after(cache_t cache, uchar* start, long off, cache_line_t* line, int status) {
+
+    int trigger = status != CACHE_HIT;
+
+    if (line != NULL && status == CACHE_HIT && line->prefetched) {
+        line->prefetched = 0;
+        cache.prefetch->useful++;
+        trigger = 1;
+    }
+
+    cache.prefetch->prefetcher->train(&cache, start, off, trigger);
+}
+
+/**
+ * @brief Returns a / b, or 0 when b is 0.
+ */
+static double ratio(unsigned long a, unsigned long b) {
+    return b ? (double)a / b : 0.0;
+}
+
+/**
+ * @brief Prints the prefetcher's accuracy, coverage and pollution.
+ *
+ * Accuracy is the share of prefetched blocks that were used, coverage the
+ * share of would-be misses the prefetcher removed.
+ *
+ * @param out Output stream
+ * @param cache The cache structure
+ */
+void print_prefetch_summary(FILE* out, cache_t cache) {
+
+    prefetch_state_t* pf = cache.prefetch;
+    unsigned long misses = total_misses(cache.stats);
+
+    fprintf(out, "Prefetch : %s, %lu issued, %lu useful, %lu polluting\n",
+        pf->prefetcher->name, pf->issued, pf->useful, pf->pollution);
+    fprintf(out, "Accuracy : %.4f\n", ratio(pf->useful, pf->issued));
+    fprintf(out, "Coverage : %.4f\n", ratio(pf->useful, pf->useful + misses));
+}
+
+/**
+ * @brief Prints the prefetcher counters as a JSON member (with trailing comma).
+ * @param out Output stream
+ * @param cache The cache structure
+ */
+void print_prefetch_json(FILE* out, cache_t cache) {
+
+    prefetch_state_t* pf = cache.prefetch;
+    unsigned long misses = total_misses(cache.stats);
+
+    fprintf(out, "  \"prefetch\": {\"prefetcher\": \"%s\", \"issued\": %lu, \"useful\": %lu, "
+        "\"pollution\": %lu, \"accuracy\": %.6f, \"coverage\": %.6f},\n", pf->prefetcher->name,
+        pf->issued, pf->useful, pf->pollution, ratio(pf->useful, pf->issued),
+        ratio(pf->useful, pf->useful + misses));
+}
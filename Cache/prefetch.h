@@ -0,0 +1,67 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include <stdio.h>
+#include "cache.h"
+
+#define STRIDE_TABLE 256        // Reference prediction table entries (indexed by PC)
+#define STRIDE_CONFIDENT 2      // Matching strides seen before the stride prefetcher issues
+#define STREAM_BUFFERS 4        // Stream buffers, reallocated least recently used first
+#define STREAM_DEPTH 4          // Blocks held by each stream buffer
+#define POLLUTION_FILTER 4096   // Remembered victims of prefetch fills (power of two)
+
+/*
+ * Prefetcher interface.
+ *
+ * lookup runs before a demand access to a block that is not cached and may
+ * supply it from a prefetch buffer (returns 1 if it did). train runs after
+ * every demand access; trigger is set on a miss or on the first demand hit
+ * to a prefetched line. Prefetched blocks are installed with prefetch_block,
+ * which keeps the accuracy and pollution counters.
+ */
+struct prefetcher_s {
+    const char* name;
+    int (*lookup)(cache_t* cache, uchar* start, long block);
+    void (*train)(cache_t* cache, uchar* start, long off, int trigger);
+};
+
+typedef struct stride_entry_s {
+    long pc;         // Instruction owning the entry
+    long last;       // Last address it accessed
+    long stride;     // Last stride seen
+    int confidence;  // Consecutive repeats of stride, saturating at STRIDE_CONFIDENT
+} stride_entry_t;
+
+typedef struct stream_buffer_s {
+    long head;           // First buffered block address
+    int count;           // Consecutive blocks buffered from head
+    unsigned long stamp; // Last use, for LRU reallocation
+} stream_buffer_t;
+
+struct prefetch_state_s {
+    const prefetcher_t* prefetcher;
+    long pc;                  // PC of the current access, set by the trace replay
+    long mask;                // Address mask of main memory
+    unsigned long issued;     // Blocks fetched by the prefetcher
+    unsigned long useful;     // Prefetched blocks later used by a demand access
+    unsigned long pollution;  // Demand misses on blocks a prefetch evicted
+    unsigned long clock;      // Stream buffer use counter
+    long filter[POLLUTION_FILTER];
+    stride_entry_t stride[STRIDE_TABLE];
+    stream_buffer_t streams[STREAM_BUFFERS];
+};
+
+extern const prefetcher_t next_line_prefetcher;
+extern const prefetcher_t stride_prefetcher;
+extern const prefetcher_t stream_prefetcher;
+
+const prefetcher_t* find_prefetcher(const char* name);
+void list_prefetchers(FILE* out);
+prefetch_state_t* create_prefetch_state(const prefetcher_t* prefetcher, long mask);
+int prefetch_block(cache_t cache, uchar* start, long off);
+void prefetch_before(cache_t cache, uchar* start, long off);
+void prefetch_after(cache_t cache, uchar* start, long off, cache_line_t* line, int status);
+void print_prefetch_summary(FILE* out, cache_t cache);
+void print_prefetch_json(FILE* out, cache_t cache);
+
+#endif
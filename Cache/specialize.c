@@ -0,0 +1,117 @@
+#include "specialize.h"
+#include <string.h>
+
+/*
+ * Instantiates get_status for a constant associativity. The body is the
+ * generic one (first empty line on a cold miss, first least frequent line
+ * on a conflict miss), with a constant trip count the compiler unrolls.
+ */
+#define DEFINE_LOOKUP(WAYS)                                                             \
+    static int get_status_e##WAYS(cache_line_t* set, uchar num_of_lines, long tag,      \
+                                  int* line_index) {                                    \
+        int victim = 0;                                                                 \
+        int empty = -1;                                                                 \
+        (void)num_of_lines;                                                             \
+        _Pragma("GCC unroll 16")                                                        \
+        for (int i = 0; i < WAYS; i++) {                                                \
+            if (!set[i].valid) {                                                        \
+                if (empty < 0) empty = i;                                               \
+                continue;                                                               \
+            }                                                                           \
+            if (set[i].tag == tag) {                                                    \
+                *line_index = i;                                                        \
+                return CACHE_HIT;                                                       \
+            }                                                                           \
+            if (set[i].frequency < set[victim].frequency) victim = i;                   \
+        }                                                                               \
+        if (empty >= 0) {                                                               \
+            *line_index = empty;                                                        \
+            return COLD_MISS;                                                           \
+        }                                                                               \
+        *line_index = victim;                                                           \
+        return CONFLICT_MISS;                                                           \
+    }
+
+/*
+ * Instantiates insert_data_to_block for a constant block size: the alignment
+ * mask and the memcpy length become constants, so the copy is inlined as a
+ * few vector moves.
+ */
+#define DEFINE_FILL(BITS)                                                               \
+    static void insert_data_to_block_b##BITS(cache_line_t* line, uchar* start,          \
+                                             long int off, uchar b, long tag) {         \
+        (void)b;                                                                        \
+        line->valid = 1;                                                                \
+        line->dirty = 0;                                                                \
+        line->state = 0;                                                                \
+        line->prefetched = 0;                                                           \
+        line->frequency = 1;                                                            \
+        line->tag = tag;                                                                \
+        if (start != NULL) {                                                            \
+            memcpy(line->block, start + (off & ~((1L << BITS) - 1)), 1UL << BITS);      \
+        }                                                                               \
+    }
+
+DEFINE_LOOKUP(1)
+DEFINE_LOOKUP(2)
+DEFINE_LOOKUP(4)
+DEFINE_LOOKUP(8)
+DEFINE_LOOKUP(16)
+
+DEFINE_FILL(5)
+DEFINE_FILL(6)
+DEFINE_FILL(7)
+
+static const lookup_entry_t lookups[] = {
+    {1, get_status_e1}, {2, get_status_e2}, {4, get_status_e4},
+    {8, get_status_e8}, {16, get_status_e16}
+};
+
+static const fill_entry_t fills[] = {
+    {5, insert_data_to_block_b5}, {6, insert_data_to_block_b6}, {7, insert_data_to_block_b7}
+};
+
+#define NUM_LOOKUPS (sizeof(lookups) / sizeof(lookups[0]))
+#define NUM_FILLS (sizeof(fills) / sizeof(fills[0]))
+
+/**
+ * @brief Installs the specialized probe and fill matching the cache geometry.
+ *
+ * Associativities 1, 2, 4, 8 and 16 and block sizes of 32, 64 and 128 bytes
+ * are specialized; anything else keeps get_status / insert_data_to_block.
+ *
+ * @param cache The cache to specialize
+ */
+void specialize_cache(cache_t* cache) {
+
+    generalize_cache(cache);
+
+    for (size_t i = 0; i < NUM_LOOKUPS; i++) {
+        if (lookups[i].E == cache->E) {
+            cache->lookup = lookups[i].lookup;
+        }
+    }
+    for (size_t i = 0; i < NUM_FILLS; i++) {
+        if (fills[i].b == cache->b) {
+            cache->fill = fills[i].fill;
+        }
+    }
+}
+
+/**
+ * @brief Installs the generic probe and fill (for comparisons and tests).
+ * @param cache The cache to reset
+ */
+void generalize_cache(cache_t* cache) {
+    cache->lookup = get_status;
+    cache->fill = insert_data_to_block;
+}
+
+/**
+ * @brief Tells whether a cache runs a specialized probe or fill.
+ * @param cache The cache structure
+ * @return 1 if either routine is specialized
+ */
+int is_specialized(cache_t cache) {
+    return cache.lookup != get_status || cache.fill != insert_data_to_block;
+}
@@ -0,0 +1,32 @@
+#ifndef SPECIALIZE_H
+#define SPECIALIZE_H
+
+#include "cache.h"
+
+/*
+ * Compile-time specialized set probes and block fills.
+ *
+ * get_status and insert_data_to_block take E and b at run time, so every
+ * access loops over a variable number of lines and every fill copies a
+ * variable number of bytes. The macros in specialize.c instantiate copies
+ * with E or B as a constant, which the compiler fully unrolls. The dispatch
+ * tables map a geometry to its instance; specialize_cache installs the
+ * matching pair in cache_t.lookup and cache_t.fill, and any geometry not in
+ * the tables keeps the generic routines.
+ */
+
+typedef struct lookup_entry_s {
+    uchar E;
+    lookup_fn_t lookup;
+} lookup_entry_t;
+
+typedef struct fill_entry_s {
+    uchar b;
+    fill_fn_t fill;
+} fill_entry_t;
+
+void specialize_cache(cache_t* cache);
+void generalize_cache(cache_t* cache);
+int is_specialized(cache_t cache);
+
+#endif
@@ -0,0 +1,269 @@
+#include "stats.h"
+#include "prefetch.h"
+#include "victim.h"
+#include "tlb.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Allocates zeroed statistics for a cache with 2^s sets.
+ * @param s Number of set index bits
+ * @return Pointer to the statistics
+ */
+cache_stats_t* create_stats(uchar s) {
+    cache_stats_t* stats = calloc(1, sizeof(cache_stats_t));
+    stats->num_sets = 1L << s;
+    stats->sets = calloc(stats->num_sets, sizeof(set_stats_t));
+    return stats;
+}
+
+/**
+ * @brief Clears every counter, keeping the per-set table.
+ * @param stats Statistics to clear
+ */
+void reset_stats(cache_stats_t* stats) {
+    set_stats_t* sets = stats->sets;
+    long num_sets = stats->num_sets;
+
+    memset(stats, 0, sizeof(cache_stats_t));
+    memset(sets, 0, num_sets * sizeof(set_stats_t));
+
+    stats->sets = sets;
+    stats->num_sets = num_sets;
+}
+
+/**
+ * @brief Adds every counter of one statistics table into another.
+ * @param into Statistics to accumulate into
+ * @param from Statistics of the same geometry to add
+ */
+void merge_stats(cache_stats_t* into, const cache_stats_t* from) {
+
+    into->read_hits += from->read_hits;
+    into->read_cold_misses += from->read_cold_misses;
+    into->read_conflict_misses += from->read_conflict_misses;
+    into->write_hits += from->write_hits;
+    into->write_cold_misses += from->write_cold_misses;
+    into->write_conflict_misses += from->write_conflict_misses;
+    into->evictions += from->evictions;
+    into->block_fills += from->block_fills;
+    into->write_throughs += from->write_throughs;
+    into->write_backs += from->write_backs;
+
+    for (long i = 0; i < into->num_sets; i++) {
+        into->sets[i].hits += from->sets[i].hits;
+        into->sets[i].misses += from->sets[i].misses;
+        into->sets[i].evictions += from->sets[i].evictions;
+    }
+}
+
+/**
+ * @brief Releases statistics allocated by create_stats.
+ */
+void free_stats(cache_stats_t* stats) {
+    free(stats->sets);
+    free(stats);
+}
+
+/**
+ * @brief Counts one access by type and outcome.
+ * @param stats Statistics to update
+ * @param set_index Set the address maps to
+ * @param is_write 1 for write_byte, 0 for read_byte
+ * @param status CACHE_HIT, COLD_MISS, or CONFLICT_MISS
+ */
+void record_access(cache_stats_t* stats, long set_index, int is_write, int status) {
+
+    set_stats_t* set = &stats->sets[set_index];
+
+    switch (status)
+    {
+        case CACHE_HIT:
+            if (is_write) stats->write_hits++; else stats->read_hits++;
+            set->hits++;
+            break;
+
+        case COLD_MISS:
+            if (is_write) stats->write_cold_misses++; else stats->read_cold_misses++;
+            set->misses++;
+            break;
+
+        case CONFLICT_MISS:
+            if (is_write) stats->write_conflict_misses++; else stats->read_conflict_misses++;
+            set->misses++;
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Counts a valid line being replaced.
+ * @param stats Statistics to update
+ * @param set_index Set the line belonged to
+ */
+void record_eviction(cache_stats_t* stats, long set_index) {
+    stats->evictions++;
+    stats->sets[set_index].evictions++;
+}
+
+/**
+ * @brief Returns the number of reads and writes counted so far.
+ */
+unsigned long total_accesses(const cache_stats_t* stats) {
+    return stats->read_hits + stats->write_hits + total_misses(stats);
+}
+
+/**
+ * @brief Returns the number of read and write misses counted so far.
+ */
+unsigned long total_misses(const cache_stats_t* stats) {
+    return stats->read_cold_misses + stats->read_conflict_misses
+        + stats->write_cold_misses + stats->write_conflict_misses;
+}
+
+/**
+ * @brief Returns the memory write traffic in bytes: write-through stores
+ *        plus whole blocks written back.
+ */
+unsigned long memory_bytes_written(cache_t cache) {
+    return cache.stats->write_throughs + (cache.stats->write_backs << cache.b);
+}
+
+/**
+ * @brief Returns the batch mode name of a write policy.
+ */
+const char* write_policy_name(uchar write_policy) {
+    switch (write_policy)
+    {
+        case WRITE_BACK | WRITE_ALLOCATE: return "back";
+        case WRITE_BACK: return "back-noallocate";
+        case WRITE_ALLOCATE: return "through-allocate";
+        default: return "through";
+    }
+}
+
+/**
+ * @brief Returns part / whole, or 0 when whole is 0.
+ */
+static double ratio(unsigned long part, unsigned long whole) {
+    return whole ? (double)part / whole : 0.0;
+}
+
+/**
+ * @brief Prints a human-readable summary and the set with the most misses.
+ * @param out Output stream
+ * @param cache The cache structure
+ */
+void print_stats_summary(FILE* out, cache_t cache) {
+
+    const cache_stats_t* st = cache.stats;
+    unsigned long accesses = total_accesses(st);
+    unsigned long misses = total_misses(st);
+
+    long hottest = 0;
+    for (long i = 1; i < st->num_sets; i++) {
+        if (st->sets[i].misses > st->sets[hottest].misses) {
+            hottest = i;
+        }
+    }
+
+    fprintf(out, "Reads    : %lu hits, %lu cold misses, %lu conflict misses\n",
+        st->read_hits, st->read_cold_misses, st->read_conflict_misses);
+    fprintf(out, "Writes   : %lu hits, %lu cold misses, %lu conflict misses\n",
+        st->write_hits, st->write_cold_misses, st->write_conflict_misses);
+    fprintf(out, "Evictions: %lu (%lu dirty write-backs)\n", st->evictions, st->write_backs);
+    fprintf(out, "Memory   : %lu bytes read, %lu bytes written\n",
+        st->block_fills << cache.b, memory_bytes_written(cache));
+    fprintf(out, "Miss rate: %.4f\n", ratio(misses, accesses));
+    fprintf(out, "Hot set  : %ld (%lu misses, %.1f%% of all misses)\n",
+        hottest, st->sets[hottest].misses, 100 * ratio(st->sets[hottest].misses, misses));
+
+    if (cache.prefetch) {
+        print_prefetch_summary(out, cache);
+    }
+    if (cache.victim) {
+        print_victim_summary(out, cache);
+    }
+    if (cache.tlb) {
+        print_tlb_summary(out, cache);
+    }
+}
+
+/**
+ * @brief Prints the statistics as a JSON object.
+ *
+ * Totals by access type and outcome, followed by a "sets" array with one
+ * [hits, misses, evictions] triple per set, in set order.
+ *
+ * @param out Output stream
+ * @param cache The cache structure
+ */
+void print_stats_json(FILE* out, cache_t cache) {
+
+    const cache_stats_t* st = cache.stats;
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"geometry\": {\"s\": %d, \"t\": %d, \"b\": %d, \"E\": %d},\n",
+        cache.s, cache.t, cache.b, cache.E);
+    fprintf(out, "  \"write_policy\": \"%s\",\n", write_policy_name(cache.write_policy));
+    fprintf(out, "  \"accesses\": %lu,\n", total_accesses(st));
+    fprintf(out, "  \"miss_rate\": %.6f,\n", ratio(total_misses(st), total_accesses(st)));
+    fprintf(out, "  \"read\": {\"hits\": %lu, \"cold_misses\": %lu, \"conflict_misses\": %lu},\n",
+        st->read_hits, st->read_cold_misses, st->read_conflict_misses);
+    fprintf(out, "  \"write\": {\"hits\": %lu, \"cold_misses\": %lu, \"conflict_misses\": %lu},\n",
+        st->write_hits, st->write_cold_misses, st->write_conflict_misses);
+    fprintf(out, "  \"evictions\": %lu,\n", st->evictions);
+    fprintf(out, "  \"memory\": {\"block_fills\": %lu, \"write_throughs\": %lu, \"write_backs\": %lu, "
+        "\"bytes_read\": %lu, \"bytes_written\": %lu},\n", st->block_fills, st->write_throughs,
+        st->write_backs, st->block_fills << cache.b, memory_bytes_written(cache));
+    if (cache.prefetch) {
+        print_prefetch_json(out, cache);
+    }
+    if (cache.victim) {
+        print_victim_json(out, cache);
+    }
+    if (cache.tlb) {
+        print_tlb_json(out, cache);
+    }
+    fprintf(out, "  \"sets\": [");
+
+    for (long i = 0; i < st->num_sets; i++) {
+        fprintf(out, "%s[%lu, %lu, %lu]", i ? ", " : "",
+            st->sets[i].hits, st->sets[i].misses, st->sets[i].evictions);
+    }
+
+    fprintf(out, "]\n}\n");
+}
+
+/**
+ * @brief Prints one CSV row per set: [prefix]set,hits,misses,evictions,miss_rate.
+ * @param out Output stream
+ * @param cache The cache structure
+ * @param prefix Text printed at the start of every row (e.g. "2," for a level column)
+ */
+void print_stats_csv_rows(FILE* out, cache_t cache, const char* prefix) {
+
+    const cache_stats_t* st = cache.stats;
+
+    for (long i = 0; i < st->num_sets; i++) {
+        const set_stats_t* set = &st->sets[i];
+        fprintf(out, "%s%ld,%lu,%lu,%lu,%.6f\n", prefix, i, set->hits, set->misses,
+            set->evictions, ratio(set->misses, set->hits + set->misses));
+    }
+}
+
+/**
+ * @brief Prints the per-set heatmap as CSV, one row per set.
+ *
+ * Columns: set, hits, misses, evictions, miss_rate. Totals are not repeated,
+ * they are the column sums.
+ *
+ * @param out Output stream
+ * @param cache The cache structure
+ */
+void print_stats_csv(FILE* out, cache_t cache) {
+    fprintf(out, "set,hits,misses,evictions,miss_rate\n");
+    print_stats_csv_rows(out, cache, "");
+}
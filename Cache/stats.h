@@ -0,0 +1,43 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+#include "cache.h"
+
+typedef struct set_stats_s {
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long evictions;
+} set_stats_t;
+
+struct cache_stats_s {
+    unsigned long read_hits;
+    unsigned long read_cold_misses;
+    unsigned long read_conflict_misses;
+    unsigned long write_hits;
+    unsigned long write_cold_misses;
+    unsigned long write_conflict_misses;
+    unsigned long evictions;
+    unsigned long block_fills;    // Blocks read from memory
+    unsigned long write_throughs; // Bytes written straight to memory
+    unsigned long write_backs;    // Dirty blocks written back to memory
+    long num_sets;
+    set_stats_t* sets; // Per-set counters, num_sets entries
+};
+
+cache_stats_t* create_stats(uchar s);
+void reset_stats(cache_stats_t* stats);
+void merge_stats(cache_stats_t* into, const cache_stats_t* from);
+void free_stats(cache_stats_t* stats);
+void record_access(cache_stats_t* stats, long set_index, int is_write, int status);
+void record_eviction(cache_stats_t* stats, long set_index);
+unsigned long total_accesses(const cache_stats_t* stats);
+unsigned long total_misses(const cache_stats_t* stats);
+unsigned long memory_bytes_written(cache_t cache);
+const char* write_policy_name(uchar write_policy);
+void print_stats_summary(FILE* out, cache_t cache);
+void print_stats_json(FILE* out, cache_t cache);
+void print_stats_csv(FILE* out, cache_t cache);
+void print_stats_csv_rows(FILE* out, cache_t cache, const char* prefix);
+
+#endif
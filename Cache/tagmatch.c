@@ -0,0 +1,286 @@
+#include "tagmatch.h"
+
+// The kernels compare tags as 64-bit lanes, so they need a 64-bit long
+#if defined(__x86_64__)
+#define HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+static int find_tag_resolve(const long* tags, int E, long tag);
+static int find_min_frequency_resolve(const uchar* frequency, int E);
+
+// Until a kernel is chosen, the first call selects one and forwards to it
+int (*find_tag)(const long* tags, int E, long tag) = find_tag_resolve;
+int (*find_min_frequency)(const uchar* frequency, int E) = find_min_frequency_resolve;
+
+static int find_tag_resolve(const long* tags, int E, long tag) {
+    select_tag_kernel();
+    return find_tag(tags, E, tag);
+}
+
+static int find_min_frequency_resolve(const uchar* frequency, int E) {
+    select_tag_kernel();
+    return find_min_frequency(frequency, E);
+}
+
+/**
+ * @brief Scalar tag match: linear scan over the tag array.
+ * @param tags Packed tag array of a set
+ * @param E Number of lines in the set
+ * @param tag Tag to search for
+ * @return Index of the first matching line, or -1
+ */
+int find_tag_scalar(const long* tags, int E, long tag) {
+    for (int i = 0; i < E; i++) {
+        if (tags[i] == tag) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Scalar victim search: first line with the lowest frequency.
+ * @param frequency Packed frequency array of a set
+ * @param E Number of lines in the set
+ * @return Index of the victim line
+ */
+int find_min_frequency_scalar(const uchar* frequency, int E) {
+    int victim = 0;
+    for (int i = 1; i < E; i++) {
+        if (frequency[i] < frequency[victim]) {
+            victim = i;
+        }
+    }
+    return victim;
+}
+
+#ifdef HAVE_X86
+
+/**
+ * @brief Returns the index of the first byte of frequency[0..E) equal to value.
+ *        Shared tail of the vector victim searches (value is known to occur).
+ */
+__attribute__((target("sse2")))
+static int first_equal_byte(const uchar* frequency, int E, uchar value) {
+    int i = 0;
+    __m128i v = _mm_set1_epi8((char)value);
+
+    for (; i + 16 <= E; i += 16) {
+        __m128i f = _mm_loadu_si128((const __m128i*)(frequency + i));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(f, v));
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    for (; i < E; i++) {
+        if (frequency[i] == value) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief SSE2 tag match, two tags per compare.
+ *
+ * SSE2 has no 64-bit compare, so each 64-bit lane is equal when both of its
+ * 32-bit halves are equal.
+ */
+__attribute__((target("sse2")))
+static int find_tag_sse2(const long* tags, int E, long tag) {
+    int i = 0;
+    __m128i t = _mm_set1_epi64x(tag);
+
+    for (; i + 2 <= E; i += 2) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(tags + i));
+        __m128i eq = _mm_cmpeq_epi32(v, t);
+        eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+        int mask = _mm_movemask_pd(_mm_castsi128_pd(eq));
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    if (i < E && tags[i] == tag) {
+        return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief SSE2 victim search: 16 frequencies per unsigned byte minimum.
+ */
+__attribute__((target("sse2")))
+static int find_min_frequency_sse2(const uchar* frequency, int E) {
+    if (E < 16) {
+        return find_min_frequency_scalar(frequency, E);
+    }
+
+    int i = 16;
+    __m128i m = _mm_loadu_si128((const __m128i*)frequency);
+
+    for (; i + 16 <= E; i += 16) {
+        m = _mm_min_epu8(m, _mm_loadu_si128((const __m128i*)(frequency + i)));
+    }
+
+    // Horizontal minimum of the 16 lanes
+    m = _mm_min_epu8(m, _mm_srli_si128(m, 8));
+    m = _mm_min_epu8(m, _mm_srli_si128(m, 4));
+    m = _mm_min_epu8(m, _mm_srli_si128(m, 2));
+    m = _mm_min_epu8(m, _mm_srli_si128(m, 1));
+    uchar min = (uchar)_mm_cvtsi128_si32(m);
+
+    for (; i < E; i++) {
+        if (frequency[i] < min) {
+            min = frequency[i];
+        }
+    }
+
+    return first_equal_byte(frequency, E, min);
+}
+
+/**
+ * @brief AVX2 tag match, four tags per compare.
+ */
+__attribute__((target("avx2")))
+static int find_tag_avx2(const long* tags, int E, long tag) {
+    int i = 0;
+    __m256i t = _mm256_set1_epi64x(tag);
+
+    for (; i + 4 <= E; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(tags + i));
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(v, t)));
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    for (; i < E; i++) {
+        if (tags[i] == tag) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief AVX2 variant of first_equal_byte.
+ *
+ * Kept separate so the AVX2 kernel never calls legacy SSE code with dirty
+ * upper ymm state, which costs a state transition on every call.
+ */
+__attribute__((target("avx2")))
+static int first_equal_byte_avx2(const uchar* frequency, int E, uchar value) {
+    int i = 0;
+    __m256i v = _mm256_set1_epi8((char)value);
+
+    for (; i + 32 <= E; i += 32) {
+        __m256i f = _mm256_loadu_si256((const __m256i*)(frequency + i));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(f, v));
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    for (; i < E; i++) {
+        if (frequency[i] == value) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief AVX2 victim search: 32 frequencies per unsigned byte minimum.
+ */
+__attribute__((target("avx2")))
+static int find_min_frequency_avx2(const uchar* frequency, int E) {
+    if (E < 32) {
+        return find_min_frequency_sse2(frequency, E);
+    }
+
+    int i = 32;
+    __m256i m = _mm256_loadu_si256((const __m256i*)frequency);
+
+    for (; i + 32 <= E; i += 32) {
+        m = _mm256_min_epu8(m, _mm256_loadu_si256((const __m256i*)(frequency + i)));
+    }
+
+    // Fold to 16 lanes, then reduce like the SSE2 kernel
+    __m128i h = _mm_min_epu8(_mm256_castsi256_si128(m), _mm256_extracti128_si256(m, 1));
+    h = _mm_min_epu8(h, _mm_srli_si128(h, 8));
+    h = _mm_min_epu8(h, _mm_srli_si128(h, 4));
+    h = _mm_min_epu8(h, _mm_srli_si128(h, 2));
+    h = _mm_min_epu8(h, _mm_srli_si128(h, 1));
+    uchar min = (uchar)_mm_cvtsi128_si32(h);
+
+    for (; i < E; i++) {
+        if (frequency[i] < min) {
+            min = frequency[i];
+        }
+    }
+
+    return first_equal_byte_avx2(frequency, E, min);
+}
+
+#endif
+
+/**
+ * @brief Returns a printable name for a kernel.
+ */
+const char* tag_kernel_name(tag_kernel_t kernel) {
+    switch (kernel)
+    {
+        case KERNEL_SSE2: return "sse2";
+        case KERNEL_AVX2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+/**
+ * @brief Switches find_tag and find_min_frequency to the given kernel.
+ * @param kernel Kernel to use
+ * @return 0 on success, -1 if the host CPU does not support the kernel
+ */
+int use_tag_kernel(tag_kernel_t kernel) {
+
+    switch (kernel)
+    {
+        case KERNEL_SCALAR:
+            find_tag = find_tag_scalar;
+            find_min_frequency = find_min_frequency_scalar;
+            return 0;
+
+#ifdef HAVE_X86
+        case KERNEL_SSE2:
+            if (!__builtin_cpu_supports("sse2")) return -1;
+            find_tag = find_tag_sse2;
+            find_min_frequency = find_min_frequency_sse2;
+            return 0;
+
+        case KERNEL_AVX2:
+            if (!__builtin_cpu_supports("avx2")) return -1;
+            find_tag = find_tag_avx2;
+            find_min_frequency = find_min_frequency_avx2;
+            return 0;
+#endif
+
+        default:
+            return -1;
+    }
+}
+
+/**
+ * @brief Picks the widest kernel the host CPU supports.
+ * @return The selected kernel
+ */
+tag_kernel_t select_tag_kernel(void) {
+
+#ifdef HAVE_X86
+    __builtin_cpu_init();
+#endif
+
+    if (use_tag_kernel(KERNEL_AVX2) == 0) return KERNEL_AVX2;
+    if (use_tag_kernel(KERNEL_SSE2) == 0) return KERNEL_SSE2;
+
+    use_tag_kernel(KERNEL_SCALAR);
+    return KERNEL_SCALAR;
+}
@@ -0,0 +1,33 @@
+#ifndef TAGMATCH_H
+#define TAGMATCH_H
+
+#include "cache.h"
+
+#define SIMD_MIN_WAYS 16 // Below this associativity the scalar scan is as fast
+
+typedef enum {
+    KERNEL_SCALAR,
+    KERNEL_SSE2,
+    KERNEL_AVX2
+} tag_kernel_t;
+
+/*
+ * Set probing kernels used by the structure-of-arrays engine.
+ *
+ * find_tag returns the index of the first element of tags[0..E) equal to tag,
+ * or -1. find_min_frequency returns the index of the first smallest element
+ * of frequency[0..E). The first call through either pointer runs
+ * select_tag_kernel, which installs the widest kernel the host CPU supports;
+ * use_tag_kernel forces a specific one.
+ */
+extern int (*find_tag)(const long* tags, int E, long tag);
+extern int (*find_min_frequency)(const uchar* frequency, int E);
+
+tag_kernel_t select_tag_kernel(void);
+int use_tag_kernel(tag_kernel_t kernel);
+const char* tag_kernel_name(tag_kernel_t kernel);
+
+int find_tag_scalar(const long* tags, int E, long tag);
+int find_min_frequency_scalar(const uchar* frequency, int E);
+
+#endif
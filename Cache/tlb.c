@@ -0,0 +1,209 @@
+#include "tlb.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Creates a TLB and an empty page table.
+ * @param entries Number of TLB entries
+ * @param ways TLB associativity (entries / ways must be a power of two)
+ * @param page_bits Page offset bits: PAGE_BITS_4K or PAGE_BITS_2M
+ * @param index INDEX_PHYSICAL (PIPT) or INDEX_VIRTUAL (VIPT)
+ * @param address_bits Width of the virtual and physical address spaces
+ * @return Pointer to the TLB
+ */
+tlb_t* create_tlb(int entries, int ways, uchar page_bits, index_mode_t index, uchar address_bits) {
+
+    tlb_t* tlb = calloc(1, sizeof(tlb_t));
+
+    tlb->entries = entries;
+    tlb->ways = ways;
+    tlb->sets = entries / ways;
+    tlb->page_bits = page_bits;
+    tlb->index = index;
+    tlb->frames = 1L << (address_bits - page_bits);
+    tlb->walk_levels = (address_bits - page_bits + PT_LEVEL_BITS - 1) / PT_LEVEL_BITS;
+    if (tlb->walk_levels < 1) {
+        tlb->walk_levels = 1;
+    }
+
+    tlb->table = malloc(sizeof(tlb_entry_t) * entries);
+    for (int i = 0; i < entries; i++) {
+        tlb->table[i].vpn = -1;
+        tlb->table[i].stamp = 0;
+    }
+
+    tlb->map_capacity = 1 << 12;
+    tlb->map_vpns = malloc(sizeof(long) * tlb->map_capacity);
+    tlb->map_pfns = malloc(sizeof(long) * tlb->map_capacity);
+    memset(tlb->map_vpns, 0xff, sizeof(long) * tlb->map_capacity);
+
+    return tlb;
+}
+
+/**
+ * @brief Returns the page table slot of a page: its own, or the empty one
+ *        where it belongs.
+ */
+static size_t page_slot(tlb_t* tlb, long vpn) {
+    size_t i = ((unsigned long)vpn * 0x9E3779B97F4A7C15UL) >> 20;
+    while (1) {
+        i &= tlb->map_capacity - 1;
+        if (tlb->map_vpns[i] == vpn || tlb->map_vpns[i] == -1) {
+            return i;
+        }
+        i++;
+    }
+}
+
+/**
+ * @brief Doubles the page table once it is half full.
+ */
+static void grow_page_table(tlb_t* tlb) {
+
+    long* vpns = tlb->map_vpns;
+    long* pfns = tlb->map_pfns;
+    size_t capacity = tlb->map_capacity;
+
+    tlb->map_capacity *= 2;
+    tlb->map_vpns = malloc(sizeof(long) * tlb->map_capacity);
+    tlb->map_pfns = malloc(sizeof(long) * tlb->map_capacity);
+    memset(tlb->map_vpns, 0xff, sizeof(long) * tlb->map_capacity);
+
+    for (size_t i = 0; i < capacity; i++) {
+        if (vpns[i] != -1) {
+            size_t j = page_slot(tlb, vpns[i]);
+            tlb->map_vpns[j] = vpns[i];
+            tlb->map_pfns[j] = pfns[i];
+        }
+    }
+
+    free(vpns);
+    free(pfns);
+}
+
+/**
+ * @brief Walks the page table, mapping the page on first touch.
+ *
+ * The n-th page touched gets frame n * FRAME_STRIDE mod frames, a
+ * permutation of the frames since the stride is odd and the frame count a
+ * power of two.
+ *
+ * @param tlb The TLB
+ * @param vpn Virtual page number
+ * @return Physical frame number
+ */
+static long walk_page_table(tlb_t* tlb, long vpn) {
+
+    tlb->walk_refs += tlb->walk_levels;
+
+    size_t slot = page_slot(tlb, vpn);
+    if (tlb->map_vpns[slot] == vpn) {
+        return tlb->map_pfns[slot];
+    }
+
+    long pfn = (long)((tlb->mapped * FRAME_STRIDE) & (tlb->frames - 1));
+    tlb->map_vpns[slot] = vpn;
+    tlb->map_pfns[slot] = pfn;
+    tlb->mapped++;
+
+    if (tlb->mapped * 2 > tlb->map_capacity) {
+        grow_page_table(tlb);
+    }
+    return pfn;
+}
+
+/**
+ * @brief Translates a virtual address into the address the cache is indexed with.
+ *
+ * PIPT returns the physical address. A VIPT cache takes its set index from
+ * the virtual address and its tag (the whole frame number) from the
+ * physical one. Pages are never shared, so that pair names a block exactly
+ * as the virtual address does, and VIPT returns the virtual address. It
+ * differs from PIPT once s + b exceeds the page offset bits.
+ *
+ * @param cache The cache behind the TLB
+ * @param vaddr Virtual address
+ * @return Address used to index and tag the cache
+ */
+long translate_address(cache_t cache, long vaddr) {
+
+    tlb_t* tlb = cache.tlb;
+    long vpn = vaddr >> tlb->page_bits;
+    tlb_entry_t* set = tlb->table + (vpn & (tlb->sets - 1)) * tlb->ways;
+    tlb_entry_t* entry = NULL;
+
+    for (int i = 0; i < tlb->ways; i++) {
+        if (set[i].vpn == vpn) {
+            entry = set + i;
+            break;
+        }
+    }
+
+    if (entry != NULL) {
+        tlb->hits++;
+    } else {
+        tlb->misses++;
+
+        // Refill the least recently used way
+        entry = set;
+        for (int i = 1; i < tlb->ways; i++) {
+            if (set[i].stamp < entry->stamp) {
+                entry = set + i;
+            }
+        }
+        entry->vpn = vpn;
+        entry->pfn = walk_page_table(tlb, vpn);
+    }
+    entry->stamp = ++tlb->clock;
+
+    if (tlb->index == INDEX_VIRTUAL) {
+        return vaddr;
+    }
+    return (entry->pfn << tlb->page_bits) | (vaddr & ((1L << tlb->page_bits) - 1));
+}
+
+/**
+ * @brief Returns a / b, or 0 when b is 0.
+ */
+static double ratio(unsigned long a, unsigned long b) {
+    return b ? (double)a / b : 0.0;
+}
+
+/**
+ * @brief Prints the TLB hit rate and the page walk traffic.
+ * @param out Output stream
+ * @param cache The cache behind the TLB
+ */
+void print_tlb_summary(FILE* out, cache_t cache) {
+
+    tlb_t* tlb = cache.tlb;
+    int synonym_bits = cache.tag_shift - tlb->page_bits;
+
+    fprintf(out, "TLB      : %d entries, %d-way, %s pages, %s: %lu hits, %lu misses (hit rate %.4f)\n",
+        tlb->entries, tlb->ways, tlb->page_bits == PAGE_BITS_2M ? "2MB" : "4KB",
+        tlb->index == INDEX_VIRTUAL ? "VIPT" : "PIPT", tlb->hits, tlb->misses,
+        ratio(tlb->hits, tlb->hits + tlb->misses));
+    fprintf(out, "Walks    : %lu (%lu page table references, %d levels), %lu pages mapped\n",
+        tlb->misses, tlb->walk_refs, tlb->walk_levels, tlb->mapped);
+
+    if (synonym_bits > 0) {
+        fprintf(out, "Indexing : %d set index bits above the page offset, %s\n", synonym_bits,
+            tlb->index == INDEX_VIRTUAL ? "VIPT sets follow virtual pages" : "PIPT sets follow frame placement");
+    }
+}
+
+/**
+ * @brief Prints the TLB counters as a JSON member (with trailing comma).
+ * @param out Output stream
+ * @param cache The cache behind the TLB
+ */
+void print_tlb_json(FILE* out, cache_t cache) {
+
+    tlb_t* tlb = cache.tlb;
+
+    fprintf(out, "  \"tlb\": {\"entries\": %d, \"ways\": %d, \"page_bytes\": %lu, \"indexing\": \"%s\", "
+        "\"hits\": %lu, \"misses\": %lu, \"hit_rate\": %.6f, \"walk_refs\": %lu, \"pages\": %lu},\n",
+        tlb->entries, tlb->ways, 1UL << tlb->page_bits, tlb->index == INDEX_VIRTUAL ? "vipt" : "pipt",
+        tlb->hits, tlb->misses, ratio(tlb->hits, tlb->hits + tlb->misses), tlb->walk_refs,
+        tlb->mapped);
+}
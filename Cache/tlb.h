@@ -0,0 +1,54 @@
+#ifndef TLB_H
+#define TLB_H
+
+#include <stdio.h>
+#include "cache.h"
+
+#define PAGE_BITS_4K 12
+#define PAGE_BITS_2M 21
+#define PT_LEVEL_BITS 9     // Page table index bits per radix level (x86-64 style)
+#define FRAME_STRIDE 40503  // Odd multiplier scattering consecutive pages over frames
+
+typedef enum {
+    INDEX_PHYSICAL, // PIPT: the cache sees the physical address
+    INDEX_VIRTUAL   // VIPT: set index from the virtual address, tag from the physical frame
+} index_mode_t;
+
+typedef struct tlb_entry_s {
+    long vpn;            // Virtual page number, -1 = empty
+    long pfn;            // Physical frame number
+    unsigned long stamp; // LRU stamp
+} tlb_entry_t;
+
+/*
+ * Address translation in front of a cache.
+ *
+ * read_byte and write_byte translate every address through a set-associative
+ * LRU TLB. A TLB miss walks a radix page table with one level per
+ * PT_LEVEL_BITS of virtual page number, and each level counts as one memory
+ * reference. Pages are mapped on first touch to frames scattered over
+ * physical memory, so consecutive virtual pages are rarely physically
+ * contiguous.
+ */
+typedef struct tlb_s {
+    int entries, ways, sets;
+    uchar page_bits;           // PAGE_BITS_4K or PAGE_BITS_2M
+    index_mode_t index;
+    int walk_levels;           // Radix levels touched by a page table walk
+    long frames;               // Physical frames in main memory
+    tlb_entry_t* table;        // sets * ways entries
+    unsigned long clock;
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long walk_refs;   // Page table entries read by walks
+    long* map_vpns;            // Page table: vpn -> pfn (open addressing), -1 = empty
+    long* map_pfns;
+    size_t map_capacity, mapped;
+} tlb_t;
+
+tlb_t* create_tlb(int entries, int ways, uchar page_bits, index_mode_t index, uchar address_bits);
+long translate_address(cache_t cache, long vaddr);
+void print_tlb_summary(FILE* out, cache_t cache);
+void print_tlb_json(FILE* out, cache_t cache);
+
+#endif
@@ -0,0 +1,370 @@
+#include "trace.h"
+#include "prefetch.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define WRITE_FLAG (1UL << 63)   // Write marker in binary trace records
+#define CORE_SHIFT 56            // Bits 56..62 of a binary record hold the core id
+#define ADDRESS_MASK ((1UL << CORE_SHIFT) - 1)
+
+/**
+ * @brief Memory-maps a trace file for batch replay.
+ *
+ * The whole file is mapped read-only and the kernel is advised that it will
+ * be read sequentially, so records are decoded straight out of the page cache.
+ *
+ * @param path Path to the trace file
+ * @param format Format of the file (TRACE_BINARY or TRACE_LACKEY)
+ * @param trace Trace handle to initialize
+ * @return 0 on success, -1 on failure
+ */
+int open_trace(const char* path, trace_format_t format, trace_t* trace) {
+
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        perror("open trace failed");
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        perror("fstat trace failed");
+        close(fd);
+        return -1;
+    }
+
+    trace->data = NULL;
+    trace->size = st.st_size;
+    trace->pos = 0;
+    trace->format = format;
+    trace->pc = 0;
+
+    // An empty file is a valid (empty) trace, but cannot be mapped
+    if (trace->size) {
+        void* map = mmap(NULL, trace->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            perror("mmap trace failed");
+            close(fd);
+            return -1;
+        }
+        madvise(map, trace->size, MADV_SEQUENTIAL);
+        trace->data = map;
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+    return 0;
+}
+
+/**
+ * @brief Unmaps a trace file opened with open_trace.
+ * @param trace Trace handle to release
+ */
+void close_trace(trace_t* trace) {
+    if (trace->data) {
+        munmap((void*)trace->data, trace->size);
+    }
+    trace->data = NULL;
+    trace->size = trace->pos = 0;
+}
+
+/**
+ * @brief Decodes up to max binary records from the current position.
+ * @param trace Trace handle
+ * @param batch Output buffer of accesses
+ * @param max Capacity of the output buffer
+ * @return Number of accesses decoded
+ */
+static size_t next_binary_batch(trace_t* trace, trace_access_t* batch, size_t max) {
+
+    size_t n = 0;
+
+    // A trailing partial record is ignored
+    while (n < max && trace->pos + sizeof(uint64_t) <= trace->size) {
+        const uchar* p = (const uchar*)trace->data + trace->pos;
+        uint64_t word = 0;
+
+        // Assemble the little-endian word byte by byte (no alignment assumptions)
+        for (int i = 7; i >= 0; i--) {
+            word = (word << 8) | p[i];
+        }
+
+        batch[n].write = (word & WRITE_FLAG) != 0;
+        batch[n].core = (word >> CORE_SHIFT) & 0x7f;
+        batch[n].pc = 0;
+        batch[n].addr = (long)(word & ADDRESS_MASK);
+        n++;
+        trace->pos += sizeof(uint64_t);
+    }
+
+    return n;
+}
+
+/**
+ * @brief Returns the value of a hexadecimal digit, or -1 if c is not one.
+ */
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/**
+ * @brief Decodes up to max accesses from lackey-style text lines.
+ *
+ * Data loads (L) become reads, stores (S) become writes, and modifies (M)
+ * become a read followed by a write. Instruction fetches (I) and any line
+ * that is not a record (e.g. "==pid==" banners) are skipped, but an
+ * instruction fetch sets the PC of the data accesses that follow it. Lackey
+ * traces are single-threaded, so every access belongs to core 0.
+ *
+ * @param trace Trace handle
+ * @param batch Output buffer of accesses
+ * @param max Capacity of the output buffer (at least 2)
+ * @return Number of accesses decoded
+ */
+static size_t next_lackey_batch(trace_t* trace, trace_access_t* batch, size_t max) {
+
+    size_t n = 0;
+    const char* data = trace->data;
+    size_t size = trace->size;
+
+    // Leave room for the two accesses produced by a modify record
+    while (n + 2 <= max && trace->pos < size) {
+        size_t i = trace->pos;
+
+        // Skip leading blanks and read the operation character
+        while (i < size && data[i] == ' ') i++;
+        char op = (i < size) ? data[i++] : '\n';
+        while (i < size && data[i] == ' ') i++;
+
+        // Parse the hexadecimal address
+        long addr = 0;
+        int digits = 0, v;
+        while (i < size && (v = hex_value(data[i])) >= 0) {
+            addr = (addr << 4) | v;
+            digits++;
+            i++;
+        }
+
+        // Move to the start of the next line
+        while (i < size && data[i] != '\n') i++;
+        trace->pos = i + 1;
+
+        if (!digits) continue;
+
+        switch (op)
+        {
+            case 'L':
+                batch[n].addr = addr;
+                batch[n].core = 0;
+                batch[n].pc = trace->pc;
+                batch[n++].write = 0;
+                break;
+
+            case 'S':
+                batch[n].addr = addr;
+                batch[n].core = 0;
+                batch[n].pc = trace->pc;
+                batch[n++].write = 1;
+                break;
+
+            case 'M':
+                batch[n].addr = addr;
+                batch[n].core = 0;
+                batch[n].pc = trace->pc;
+                batch[n++].write = 0;
+                batch[n].addr = addr;
+                batch[n].core = 0;
+                batch[n].pc = trace->pc;
+                batch[n++].write = 1;
+                break;
+
+            case 'I':
+                trace->pc = addr;
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    return n;
+}
+
+/**
+ * @brief Decodes the next block of accesses from a trace.
+ * @param trace Trace handle
+ * @param batch Output buffer of accesses
+ * @param max Capacity of the output buffer
+ * @return Number of accesses decoded, 0 at end of trace
+ */
+size_t next_trace_batch(trace_t* trace, trace_access_t* batch, size_t max) {
+    if (trace->format == TRACE_LACKEY) {
+        return next_lackey_batch(trace, batch, max);
+    }
+    return next_binary_batch(trace, batch, max);
+}
+
+/**
+ * @brief Replays a whole trace through read_byte and write_byte.
+ *
+ * Accesses are decoded TRACE_BATCH at a time and then pushed through the
+ * cache in a tight loop. Addresses are masked to the simulated address space.
+ * Trace records carry no data, so a write stores the byte already in memory.
+ *
+ * @param cache The cache structure
+ * @param mem Pointer to the simulated main memory
+ * @param mask Address mask of the simulated main memory
+ * @param trace Trace handle positioned at the first record
+ * @return Number of accesses replayed
+ */
+unsigned long run_trace(cache_t cache, uchar* mem, long mask, trace_t* trace) {
+
+    static trace_access_t batch[TRACE_BATCH];
+    unsigned long total = 0;
+    size_t n;
+
+    while ((n = next_trace_batch(trace, batch, TRACE_BATCH)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            long off = batch[i].addr & mask;
+            if (cache.prefetch) {
+                cache.prefetch->pc = batch[i].pc;
+            }
+            if (batch[i].write) {
+                write_byte(cache, mem, off, mem[off]);
+            } else {
+                read_byte(cache, mem, off);
+            }
+        }
+        total += n;
+    }
+
+    return total;
+}
+
+/**
+ * @brief Replays a whole trace through the structure-of-arrays engine.
+ *
+ * Same as run_trace, but accesses go through soa_read_byte and soa_write_byte.
+ *
+ * @param cache The cache structure
+ * @param mem Pointer to the simulated main memory
+ * @param mask Address mask of the simulated main memory
+ * @param trace Trace handle positioned at the first record
+ * @return Number of accesses replayed
+ */
+unsigned long run_trace_soa(soa_cache_t cache, uchar* mem, long mask, trace_t* trace) {
+
+    static trace_access_t batch[TRACE_BATCH];
+    unsigned long total = 0;
+    size_t n;
+
+    while ((n = next_trace_batch(trace, batch, TRACE_BATCH)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            long off = batch[i].addr & mask;
+            if (batch[i].write) {
+                soa_write_byte(cache, mem, off, mem[off]);
+            } else {
+                soa_read_byte(cache, mem, off);
+            }
+        }
+        total += n;
+    }
+
+    return total;
+}
+
+/**
+ * @brief Replays a whole trace through a cache hierarchy.
+ *
+ * Same as run_trace, but accesses go through hierarchy_read_byte and
+ * hierarchy_write_byte.
+ *
+ * @param h The cache hierarchy
+ * @param mem Pointer to the simulated main memory
+ * @param mask Address mask of the simulated main memory
+ * @param trace Trace handle positioned at the first record
+ * @return Number of accesses replayed
+ */
+unsigned long run_trace_hierarchy(hierarchy_t* h, uchar* mem, long mask, trace_t* trace) {
+
+    static trace_access_t batch[TRACE_BATCH];
+    unsigned long total = 0;
+    size_t n;
+
+    while ((n = next_trace_batch(trace, batch, TRACE_BATCH)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            long off = batch[i].addr & mask;
+            if (batch[i].write) {
+                hierarchy_write_byte(h, mem, off, mem[off]);
+            } else {
+                hierarchy_read_byte(h, mem, off);
+            }
+        }
+        total += n;
+    }
+
+    return total;
+}
+
+/**
+ * @brief Replays a trace on a multi-core system, one private cache per core.
+ *
+ * Each record runs on the core it names, folded into the available cores.
+ *
+ * @param smp The multi-core system
+ * @param mem Pointer to the simulated main memory
+ * @param mask Address mask of the simulated main memory
+ * @param trace Trace handle positioned at the first record
+ * @return Number of accesses replayed
+ */
+unsigned long run_trace_smp(smp_t* smp, uchar* mem, long mask, trace_t* trace) {
+
+    static trace_access_t batch[TRACE_BATCH];
+    unsigned long total = 0;
+    size_t n;
+
+    while ((n = next_trace_batch(trace, batch, TRACE_BATCH)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            long off = batch[i].addr & mask;
+            int core = batch[i].core % smp->cores;
+            if (batch[i].write) {
+                smp_write_byte(smp, core, mem, off, mem[off]);
+            } else {
+                smp_read_byte(smp, core, mem, off);
+            }
+        }
+        total += n;
+    }
+
+    return total;
+}
+
+/**
+ * @brief Feeds a whole trace to a miss-ratio curve.
+ * @param mrc Curve state
+ * @param mask Address mask of the simulated main memory
+ * @param trace Trace handle positioned at the first record
+ * @return Number of accesses replayed
+ */
+unsigned long run_trace_mrc(mrc_t* mrc, long mask, trace_t* trace) {
+
+    static trace_access_t batch[TRACE_BATCH];
+    unsigned long total = 0;
+    size_t n;
+
+    while ((n = next_trace_batch(trace, batch, TRACE_BATCH)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            mrc_access(mrc, batch[i].addr & mask);
+        }
+        total += n;
+    }
+
+    return total;
+}
@@ -0,0 +1,42 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stddef.h>
+#include "cache.h"
+#include "cache_soa.h"
+#include "hierarchy.h"
+#include "coherence.h"
+#include "mrc.h"
+
+#define TRACE_BATCH 4096 // Accesses decoded per block before replay
+
+typedef enum {
+    TRACE_BINARY, // Packed 64-bit little-endian words: bit 63 = write, 62..56 = core, 55..0 = address
+    TRACE_LACKEY  // Valgrind lackey text: "I addr,size", " L addr,size", " S ...", " M ..."
+} trace_format_t;
+
+typedef struct trace_s {
+    const char* data;      // Memory-mapped file contents
+    size_t size;           // Size of the mapping in bytes
+    size_t pos;            // Current read position in the mapping
+    trace_format_t format;
+    long pc;               // Last instruction fetched (lackey), the PC of the next accesses
+} trace_t;
+
+typedef struct trace_access_s {
+    long addr;
+    uchar write;
+    uchar core; // Issuing core (thread) for coherence simulation
+    long pc;    // Instruction that issued the access, 0 if the trace has none
+} trace_access_t;
+
+int open_trace(const char* path, trace_format_t format, trace_t* trace);
+void close_trace(trace_t* trace);
+size_t next_trace_batch(trace_t* trace, trace_access_t* batch, size_t max);
+unsigned long run_trace(cache_t cache, uchar* mem, long mask, trace_t* trace);
+unsigned long run_trace_soa(soa_cache_t cache, uchar* mem, long mask, trace_t* trace);
+unsigned long run_trace_hierarchy(hierarchy_t* h, uchar* mem, long mask, trace_t* trace);
+unsigned long run_trace_smp(smp_t* smp, uchar* mem, long mask, trace_t* trace);
+unsigned long run_trace_mrc(mrc_t* mrc, long mask, trace_t* trace);
+
+#endif
@@ -0,0 +1,122 @@
+#include "victim.h"
+#include "stats.h"
+#include <stdlib.h>
+
+/**
+ * @brief Allocates an empty victim or miss cache.
+ * @param entries Number of entries (1 .. MAX_VICTIM_ENTRIES)
+ * @param mode VICTIM_CACHE or MISS_CACHE
+ * @return Pointer to the buffer
+ */
+victim_cache_t* create_victim_cache(int entries, victim_mode_t mode) {
+
+    victim_cache_t* vc = calloc(1, sizeof(victim_cache_t));
+
+    vc->mode = mode;
+    vc->entries = entries;
+    for (int i = 0; i < entries; i++) {
+        vc->blocks[i] = -1;
+    }
+
+    return vc;
+}
+
+/**
+ * @brief Looks a missing block up in the buffer.
+ *
+ * A victim cache hands the block back to the cache and frees the entry (the
+ * line the cache evicts in exchange takes its place). A miss cache keeps its
+ * copy and only refreshes it.
+ *
+ * @param vc The buffer
+ * @param block Block address
+ * @return 1 if the buffer held the block
+ */
+int victim_probe(victim_cache_t* vc, long block) {
+
+    vc->probes++;
+
+    for (int i = 0; i < vc->entries; i++) {
+        if (vc->blocks[i] == block) {
+            vc->hits++;
+            if (vc->mode == VICTIM_CACHE) {
+                vc->blocks[i] = -1;
+                vc->stamps[i] = 0;
+            } else {
+                vc->stamps[i] = ++vc->clock;
+            }
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Places a block in the buffer, replacing the least recently used entry.
+ * @param vc The buffer
+ * @param block Block address
+ */
+void victim_insert(victim_cache_t* vc, long block) {
+
+    int slot = 0;
+
+    for (int i = 0; i < vc->entries; i++) {
+        if (vc->blocks[i] == block) {
+            slot = i;
+            break;
+        }
+        if (vc->stamps[i] < vc->stamps[slot]) {
+            slot = i;
+        }
+    }
+
+    vc->blocks[slot] = block;
+    vc->stamps[slot] = ++vc->clock;
+    vc->inserts++;
+}
+
+/**
+ * @brief Returns the name of a buffer mode.
+ */
+const char* victim_mode_name(victim_mode_t mode) {
+    return mode == MISS_CACHE ? "miss cache" : "victim cache";
+}
+
+/**
+ * @brief Returns a / b, or 0 when b is 0.
+ */
+static double ratio(unsigned long a, unsigned long b) {
+    return b ? (double)a / b : 0.0;
+}
+
+/**
+ * @brief Prints the buffer hits and the miss rate left once they are served.
+ * @param out Output stream
+ * @param cache The cache structure
+ */
+void print_victim_summary(FILE* out, cache_t cache) {
+
+    victim_cache_t* vc = cache.victim;
+    unsigned long accesses = total_accesses(cache.stats);
+
+    fprintf(out, "Victim   : %s, %d entries, %lu hits of %lu misses (%.1f%%)\n",
+        victim_mode_name(vc->mode), vc->entries, vc->hits, vc->probes,
+        100 * ratio(vc->hits, vc->probes));
+    fprintf(out, "With buf : miss rate %.4f\n",
+        ratio(total_misses(cache.stats) - vc->hits, accesses));
+}
+
+/**
+ * @brief Prints the buffer counters as a JSON member (with trailing comma).
+ * @param out Output stream
+ * @param cache The cache structure
+ */
+void print_victim_json(FILE* out, cache_t cache) {
+
+    victim_cache_t* vc = cache.victim;
+
+    fprintf(out, "  \"victim\": {\"mode\": \"%s\", \"entries\": %d, \"probes\": %lu, \"hits\": %lu, "
+        "\"inserts\": %lu, \"miss_rate\": %.6f},\n", victim_mode_name(vc->mode), vc->entries,
+        vc->probes, vc->hits, vc->inserts,
+        ratio(total_misses(cache.stats) - vc->hits, total_accesses(cache.stats)));
+}
@@ -0,0 +1,41 @@
+#ifndef VICTIM_H
+#define VICTIM_H
+
+#include <stdio.h>
+#include "cache.h"
+
+#define MAX_VICTIM_ENTRIES 64
+
+typedef enum {
+    VICTIM_CACHE, // Holds lines evicted from the cache; a hit swaps the line back in
+    MISS_CACHE    // Holds copies of the blocks the cache missed on (Jouppi)
+} victim_mode_t;
+
+/*
+ * Small fully-associative buffer beside a cache (Jouppi 1990).
+ *
+ * install_block probes it before fetching a missing block from memory and
+ * feeds it evicted lines (victim cache) or fetched blocks (miss cache). Only
+ * block addresses are kept: dirty victims are written back when they leave
+ * the cache, so memory always holds the data of a buffered block. Buffer
+ * hits still count as misses of the cache itself, but need no block fill.
+ */
+typedef struct victim_cache_s {
+    victim_mode_t mode;
+    int entries;
+    long blocks[MAX_VICTIM_ENTRIES];          // Block addresses, -1 = empty
+    unsigned long stamps[MAX_VICTIM_ENTRIES]; // LRU stamps
+    unsigned long clock;
+    unsigned long probes;  // Cache misses looked up in the buffer
+    unsigned long hits;    // Misses served by the buffer
+    unsigned long inserts; // Blocks placed in the buffer
+} victim_cache_t;
+
+victim_cache_t* create_victim_cache(int entries, victim_mode_t mode);
+int victim_probe(victim_cache_t* vc, long block);
+void victim_insert(victim_cache_t* vc, long block);
+const char* victim_mode_name(victim_mode_t mode);
+void print_victim_summary(FILE* out, cache_t cache);
+void print_victim_json(FILE* out, cache_t cache);
+
+#endif